@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_tags_evidence_id ON tags(evidence_id, tag_id, name);
+
+-- +migrate Down
+DROP INDEX idx_tags_evidence_id;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_evidence_operation_slug ON evidence(operation_slug, recorded_date);
+
+-- +migrate Down
+DROP INDEX idx_evidence_operation_slug;
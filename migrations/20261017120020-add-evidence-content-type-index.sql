@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_evidence_content_type ON evidence(content_type, recorded_date);
+
+-- +migrate Down
+DROP INDEX idx_evidence_content_type;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_evidence_recorded_date ON evidence(recorded_date);
+
+-- +migrate Down
+DROP INDEX idx_evidence_recorded_date;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_evidence_upload_date ON evidence(upload_date);
+
+-- +migrate Down
+DROP INDEX idx_evidence_upload_date;
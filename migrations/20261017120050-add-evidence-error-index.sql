@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_evidence_has_error ON evidence(error) WHERE error != '';
+
+-- +migrate Down
+DROP INDEX idx_evidence_has_error;
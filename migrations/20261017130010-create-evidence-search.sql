@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE VIRTUAL TABLE evidence_search USING fts5(description, content_text, content='evidence', content_rowid='id');
+
+-- +migrate Down
+DROP TABLE evidence_search;
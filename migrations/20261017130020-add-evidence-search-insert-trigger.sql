@@ -0,0 +1,7 @@
+-- +migrate Up
+CREATE TRIGGER evidence_search_ai AFTER INSERT ON evidence BEGIN
+    INSERT INTO evidence_search(rowid, description, content_text) VALUES (new.id, new.description, new.content_text);
+END;
+
+-- +migrate Down
+DROP TRIGGER evidence_search_ai;
@@ -0,0 +1,7 @@
+-- +migrate Up
+CREATE TRIGGER evidence_search_ad AFTER DELETE ON evidence BEGIN
+    INSERT INTO evidence_search(evidence_search, rowid, description, content_text) VALUES ('delete', old.id, old.description, old.content_text);
+END;
+
+-- +migrate Down
+DROP TRIGGER evidence_search_ad;
@@ -0,0 +1,8 @@
+-- +migrate Up
+CREATE TRIGGER evidence_search_au AFTER UPDATE OF description, content_text ON evidence BEGIN
+    INSERT INTO evidence_search(evidence_search, rowid, description, content_text) VALUES ('delete', old.id, old.description, old.content_text);
+    INSERT INTO evidence_search(rowid, description, content_text) VALUES (new.id, new.description, new.content_text);
+END;
+
+-- +migrate Down
+DROP TRIGGER evidence_search_au;
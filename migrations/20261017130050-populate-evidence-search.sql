@@ -0,0 +1,5 @@
+-- +migrate Up
+INSERT INTO evidence_search(evidence_search) VALUES ('rebuild');
+
+-- +migrate Down
+INSERT INTO evidence_search(evidence_search) VALUES ('delete-all');
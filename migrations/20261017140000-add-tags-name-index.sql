@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_tags_name ON tags(name COLLATE NOCASE, evidence_id);
+
+-- +migrate Down
+DROP INDEX idx_tags_name;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_evidence_content_hash ON evidence(content_hash, operation_slug);
+
+-- +migrate Down
+DROP INDEX idx_evidence_content_hash;
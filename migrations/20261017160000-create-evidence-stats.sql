@@ -0,0 +1,12 @@
+-- +migrate Up
+CREATE TABLE evidence_stats (
+    operation_slug TEXT NOT NULL,
+    content_type TEXT NOT NULL,
+    pending INTEGER NOT NULL DEFAULT 0,
+    failed INTEGER NOT NULL DEFAULT 0,
+    submitted INTEGER NOT NULL DEFAULT 0,
+    PRIMARY KEY (operation_slug, content_type)
+) WITHOUT ROWID;
+
+-- +migrate Down
+DROP TABLE evidence_stats;
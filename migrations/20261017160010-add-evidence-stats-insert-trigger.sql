@@ -0,0 +1,15 @@
+-- +migrate Up
+CREATE TRIGGER evidence_stats_ai AFTER INSERT ON evidence BEGIN
+    INSERT INTO evidence_stats(operation_slug, content_type, pending, failed, submitted)
+    VALUES (new.operation_slug, new.content_type,
+            new.upload_date IS NULL AND new.error = '',
+            new.upload_date IS NULL AND new.error != '',
+            new.upload_date IS NOT NULL)
+    ON CONFLICT(operation_slug, content_type) DO UPDATE SET
+        pending = pending + excluded.pending,
+        failed = failed + excluded.failed,
+        submitted = submitted + excluded.submitted;
+END;
+
+-- +migrate Down
+DROP TRIGGER evidence_stats_ai;
@@ -0,0 +1,11 @@
+-- +migrate Up
+CREATE TRIGGER evidence_stats_ad AFTER DELETE ON evidence BEGIN
+    UPDATE evidence_stats SET
+        pending = pending - (old.upload_date IS NULL AND old.error = ''),
+        failed = failed - (old.upload_date IS NULL AND old.error != ''),
+        submitted = submitted - (old.upload_date IS NOT NULL)
+    WHERE operation_slug = old.operation_slug AND content_type = old.content_type;
+END;
+
+-- +migrate Down
+DROP TRIGGER evidence_stats_ad;
@@ -0,0 +1,20 @@
+-- +migrate Up
+CREATE TRIGGER evidence_stats_au AFTER UPDATE OF operation_slug, content_type, error, upload_date ON evidence BEGIN
+    UPDATE evidence_stats SET
+        pending = pending - (old.upload_date IS NULL AND old.error = ''),
+        failed = failed - (old.upload_date IS NULL AND old.error != ''),
+        submitted = submitted - (old.upload_date IS NOT NULL)
+    WHERE operation_slug = old.operation_slug AND content_type = old.content_type;
+    INSERT INTO evidence_stats(operation_slug, content_type, pending, failed, submitted)
+    VALUES (new.operation_slug, new.content_type,
+            new.upload_date IS NULL AND new.error = '',
+            new.upload_date IS NULL AND new.error != '',
+            new.upload_date IS NOT NULL)
+    ON CONFLICT(operation_slug, content_type) DO UPDATE SET
+        pending = pending + excluded.pending,
+        failed = failed + excluded.failed,
+        submitted = submitted + excluded.submitted;
+END;
+
+-- +migrate Down
+DROP TRIGGER evidence_stats_au;
@@ -0,0 +1,10 @@
+-- +migrate Up
+INSERT INTO evidence_stats(operation_slug, content_type, pending, failed, submitted)
+SELECT operation_slug, content_type,
+       SUM(upload_date IS NULL AND error = ''),
+       SUM(upload_date IS NULL AND error != ''),
+       SUM(upload_date IS NOT NULL)
+FROM evidence GROUP BY operation_slug, content_type;
+
+-- +migrate Down
+DELETE FROM evidence_stats;
@@ -0,0 +1,12 @@
+-- +migrate Up
+CREATE TABLE upload_queue (
+    evidence_id INTEGER PRIMARY KEY,
+    state INTEGER NOT NULL DEFAULT 0,
+    attempts INTEGER NOT NULL DEFAULT 0,
+    next_attempt_at INTEGER NOT NULL DEFAULT 0,
+    last_error TEXT NOT NULL DEFAULT '',
+    queued_at INTEGER NOT NULL DEFAULT 0
+);
+
+-- +migrate Down
+DROP TABLE upload_queue;
@@ -0,0 +1,5 @@
+-- +migrate Up
+CREATE INDEX idx_upload_queue_state ON upload_queue (state, next_attempt_at);
+
+-- +migrate Down
+DROP INDEX idx_upload_queue_state;
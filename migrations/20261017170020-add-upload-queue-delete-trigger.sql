@@ -0,0 +1,7 @@
+-- +migrate Up
+CREATE TRIGGER upload_queue_evidence_ad AFTER DELETE ON evidence BEGIN
+    DELETE FROM upload_queue WHERE evidence_id = old.id;
+END;
+
+-- +migrate Down
+DROP TRIGGER upload_queue_evidence_ad;
@@ -107,6 +107,12 @@ QString AppConfig::defaultValue(const QString &key)
     if (key == CONFIG::SHOW_WELCOME_SCREEN)
         return QStringLiteral("true");
 
+    if (key == CONFIG::SHARE_IDENTICAL_EVIDENCE)
+        return QStringLiteral("false");
+
+    if (key == CONFIG::TAG_CACHE_EXPIRY)
+        return QStringLiteral("60");
+
     if (key == CONFIG::SHORTCUT_CAPTURECLIPBOARD) {
           if(!get()->appSettings->value(key).isValid())
               return QStringLiteral("Meta+Alt+v");
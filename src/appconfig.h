@@ -22,6 +22,8 @@ struct CONFIG {
     inline static const auto SHORTCUT_CAPTUREWINDOW = QStringLiteral("captureWindowShortcut");
     inline static const auto SHORTCUT_CAPTURECLIPBOARD = QStringLiteral("captureClipboardShortcut");
     inline static const auto SHOW_WELCOME_SCREEN = QStringLiteral("showWelcomeScreen");
+    inline static const auto SHARE_IDENTICAL_EVIDENCE = QStringLiteral("shareIdenticalEvidence");
+    inline static const auto TAG_CACHE_EXPIRY = QStringLiteral("tagCacheExpirySeconds");
 };
 
 /// AppConfig is a singleton for accessing the application's configuration.
@@ -104,5 +106,7 @@ private:
         CONFIG::SHORTCUT_CAPTUREWINDOW,
         CONFIG::SHORTCUT_CAPTURECLIPBOARD,
         CONFIG::SHOW_WELCOME_SCREEN,
+        CONFIG::SHARE_IDENTICAL_EVIDENCE,
+        CONFIG::TAG_CACHE_EXPIRY,
     };
 };
@@ -62,6 +62,10 @@ bool CodeBlockView::saveEvidence() {
   return false;
 }
 
+QString CodeBlockView::searchableText() const {
+  return loadedCodeblock.content;
+}
+
 void CodeBlockView::clearPreview() {
   codeEditor->clear();
   sourceTextBox->clear();
@@ -35,6 +35,9 @@ class CodeBlockView : public EvidencePreview {
   /// Returns False if failed.
   virtual bool saveEvidence() override;
 
+  /// searchableText returns the codeblock's content. Inherited from EvidencePreview
+  [[nodiscard]] virtual QString searchableText() const override;
+
   /// clearPreview removes the content, source, and sets the language to "Plain Text". Inherited
   /// from EvidencePreview
   virtual void clearPreview() override;
@@ -3,8 +3,11 @@
 #include <QFile>
 #include <QTextEdit>
 #include <QSplitter>
+#include <utility>
 #include "components/evidencepreview.h"
 #include "db/databaseconnection.h"
+#include "db/databaseworker.h"
+#include "helpers/file_helpers.h"
 #include "components/aspectratio_pixmap_label/imageview.h"
 #include "components/code_editor/codeblockview.h"
 #include "components/error_view/errorview.h"
@@ -94,11 +97,26 @@ void EvidenceEditor::setEnabled(bool enable) {
 
 void EvidenceEditor::loadData()
 {
-    // get local db evidence data
     clearEditor();
-    originalEvidenceData = db->getEvidenceDetails(evidenceID);
+    const auto generation = ++loadGeneration;
+    const auto id = evidenceID;
+    DatabaseWorker::get()->run([id](DatabaseConnection* conn) {
+        auto evidence = conn->getEvidenceDetails(id);
+        return std::make_pair(evidence, evidence.id == -1 ? conn->errorString() : QString());
+    }).then(this, [this, generation](const std::pair<model::Evidence, QString>& result) {
+        if (generation != loadGeneration)
+            return;  // other evidence was shown in the meantime
+        showEvidence(result.first, result.second);
+    });
+}
+
+void EvidenceEditor::showEvidence(const model::Evidence& evidence, const QString& errorText)
+{
+    clearEditor();
+    originalEvidenceData = evidence;
     if(originalEvidenceData.id == -1) {
-        loadedPreview = new ErrorView(tr("Unable to load evidence: %1").arg(db->errorString()), this);
+        loadedPreview = new ErrorView(tr("Unable to load evidence: %1").arg(errorText), this);
+        splitter->insertWidget(0, loadedPreview);
         return;
     }
 
@@ -121,10 +139,20 @@ void EvidenceEditor::loadData()
 }
 
 void EvidenceEditor::revert() {
-  tagEditor->clear();
-  originalEvidenceData = db->getEvidenceDetails(evidenceID);
-  descriptionTextBox->setText(originalEvidenceData.description);
-  tagEditor->loadTags(operationSlug, originalEvidenceData.tags);
+  if (evidenceID <= 0)
+    return;
+  const auto generation = loadGeneration;
+  const auto id = evidenceID;
+  DatabaseWorker::get()->run([id](DatabaseConnection* conn) {
+    return conn->getEvidenceDetails(id);
+  }).then(this, [this, generation](const model::Evidence& evidence) {
+    if (generation != loadGeneration || evidence.id == -1)
+      return;
+    tagEditor->clear();
+    originalEvidenceData = evidence;
+    descriptionTextBox->setText(originalEvidenceData.description);
+    tagEditor->loadTags(operationSlug, originalEvidenceData.tags);
+  });
 }
 
 void EvidenceEditor::updateEvidence(qint64 evidenceID, bool readonly) {
@@ -134,9 +162,19 @@ void EvidenceEditor::updateEvidence(qint64 evidenceID, bool readonly) {
   this->evidenceID = evidenceID;
   if (evidenceID > 0) {
     loadData();
+  } else {
+    loadGeneration++;
   }
 }
 
+void EvidenceEditor::updateEvidence(const model::Evidence& evidence, bool readonly) {
+  setEnabled(false);
+  loadGeneration++;
+  this->readonly = readonly;
+  this->evidenceID = evidence.id;
+  showEvidence(evidence, QString());
+}
+
 void EvidenceEditor::clearEditor() {
   tagEditor->clear();
   descriptionTextBox->clear();
@@ -154,49 +192,43 @@ void EvidenceEditor::onTagsLoaded(bool success) {
 
 // saveEvidence is a helper method to save (to the database) the currently
 // loaded evidence, using the editor changes.
-SaveEvidenceResponse EvidenceEditor::saveEvidence()
+QFuture<SaveEvidenceResponse> EvidenceEditor::saveEvidence()
 {
+    // until the evidence has been read, there is nothing that could have been edited
+    if (evidenceID <= 0 || originalEvidenceData.id != evidenceID)
+        return QtFuture::makeReadyValueFuture(SaveEvidenceResponse(true, QString(), originalEvidenceData));
+
     if (loadedPreview != nullptr) {
         loadedPreview->saveEvidence();
     }
     auto evi = encodeEvidence();
-    auto resp = SaveEvidenceResponse(evi);
-    db->updateEvidenceDescription(evi.description, evi.id);
-    if(!db->errorString().isEmpty()) {
-        resp.actionSucceeded = false;
-        resp.errorText = db->errorString();
-        return resp;
-    }
-
-    db->setEvidenceTags(evi.tags, evi.id);
-    if(!db->errorString().isEmpty()) {
-        resp.actionSucceeded = false;
-        resp.errorText = db->errorString();
+    const bool hasPreview = loadedPreview != nullptr;
+    const auto contentText = hasPreview ? loadedPreview->searchableText() : QString();
+    // the file may have been edited, so it is re-hashed (on the global pool) before anything is
+    // written
+    auto hashed = hasPreview ? FileHelpers::sha256Async(evi.path)
+                             : QtFuture::makeReadyValueFuture(QString());
+    return hashed.then([evi, hasPreview, contentText](const QString& contentHash) {
+        return DatabaseWorker::get()->run([evi, hasPreview, contentText, contentHash](DatabaseConnection* conn) {
+            auto resp = SaveEvidenceResponse(evi);
+            if (!conn->updateEvidenceDescription(evi.description, evi.id)
+                || (hasPreview && !conn->updateEvidenceContentText(contentText, evi.id))) {
+                resp.errorText = conn->errorString();
+                return resp;
+            }
+            if (hasPreview)
+                conn->updateEvidenceContentHash(contentHash, evi.id);
+            if (!conn->setEvidenceTags(evi.tags, evi.id)) {
+                resp.errorText = conn->errorString();
+                return resp;
+            }
+            resp.actionSucceeded = true;
+            return resp;
+        });
+    }).unwrap().then(this, [this, generation = loadGeneration](const SaveEvidenceResponse& resp) {
+        // keep revert (and the next save) in step with what is now stored
+        if (resp.actionSucceeded && generation == loadGeneration)
+            originalEvidenceData = resp.model;
         return resp;
-    }
-    resp.actionSucceeded = true;
-    return resp;
-}
-
-QList<DeleteEvidenceResponse> EvidenceEditor::deleteEvidence(QList<qint64> evidenceIDs)
-{
-    QList<DeleteEvidenceResponse> responses;
-    for (qint64 id : evidenceIDs) {
-        model::Evidence evi = db->getEvidenceDetails(id);
-        DeleteEvidenceResponse resp(evi);
-        resp.dbDeleteSuccess = db->deleteEvidence(evi.id);
-        if(!resp.dbDeleteSuccess)
-            resp.errorText = db->errorString();
-
-        auto localFile = QFile(evi.path);
-        if (!localFile.remove()) {
-            resp.fileDeleteSuccess = false;
-            resp.errorText.append(QStringLiteral("\n%1").arg(localFile.errorString()));
-        } else {
-            resp.fileDeleteSuccess = true;
-        }
-        resp.errorText = resp.errorText.trimmed();
-        responses.append(resp);
-    }
-    return responses;
+    });
 }
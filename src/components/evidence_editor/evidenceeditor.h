@@ -1,8 +1,8 @@
 #pragma once
 
+#include <QFuture>
 #include <QWidget>
 
-#include "deleteevidenceresponse.h"
 #include "saveevidenceresponse.h"
 
 class QSplitter;
@@ -21,17 +21,20 @@ class EvidenceEditor : public QWidget {
 
  private:
   void buildUi();
+  /// loadData reads the evidence on the database worker, and then shows it (see showEvidence)
   void loadData();
+  /// showEvidence fills the editor with the given evidence. errorText is shown instead if the
+  /// evidence could not be read.
+  void showEvidence(const model::Evidence& evidence, const QString& errorText);
   void clearEditor();
 
  public:
   model::Evidence encodeEvidence();
   void setEnabled(bool enable);
-  SaveEvidenceResponse saveEvidence();
+  /// saveEvidence stores the editor changes on the database worker. The returned future resolves
+  /// (on the GUI thread) once they are saved.
+  QFuture<SaveEvidenceResponse> saveEvidence();
 
-  /// deleteEvidence is a helper method to delete both the database record and
-  /// file location of the provided evidence IDs
-  QList<DeleteEvidenceResponse> deleteEvidence(QList<qint64> evidenceIDs);
 
   /// revert re-loads the evidence to restore the content to the saved version.
   /// Only useful when used in the evidence manager.
@@ -42,6 +45,8 @@ class EvidenceEditor : public QWidget {
 
  public slots:
   void updateEvidence(qint64 evidenceID, bool readonly);
+  /// updateEvidence shows evidence that has already been read from the database
+  void updateEvidence(const model::Evidence& evidence, bool readonly);
 
  private slots:
   void onTagsLoaded(bool success);
@@ -51,6 +56,9 @@ class EvidenceEditor : public QWidget {
   qint64 evidenceID = 0;
   QString operationSlug;
   bool readonly = false;
+  /// loadGeneration is incremented whenever different evidence is shown, so that reads finishing
+  /// afterwards are dropped
+  quint64 loadGeneration = 0;
 
   model::Evidence originalEvidenceData;
 
@@ -3,6 +3,8 @@
 #include "models/evidence.h"
 
 struct SaveEvidenceResponse {
+  SaveEvidenceResponse() = default;
+
   SaveEvidenceResponse(model::Evidence model)
     : model(model) { }
 
@@ -6,4 +6,8 @@ bool EvidencePreview::saveEvidence() {
   return true;
 }
 
+QString EvidencePreview::searchableText() const {
+  return QString();
+}
+
 void EvidencePreview::setReadonly(bool readonly) { this->readonly = readonly; }
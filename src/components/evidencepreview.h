@@ -27,6 +27,10 @@ class EvidencePreview : public QWidget {
   /// saveEvidence allows the underlying evidence to be re-written to disk.
   virtual bool saveEvidence();
 
+  /// searchableText returns the text content of the evidence, used for evidence search. The
+  /// default implementation returns an empty string (i.e. nothing to search)
+  [[nodiscard]] virtual QString searchableText() const;
+
   /// setReadonly marks the evidence preview as read-only, disallowing editing. The default
   /// implementation sets the internal flag -- it is the responsibilty of the underlying evidence to
   /// act on this data.
@@ -1,19 +1,17 @@
 #include "tagcache.h"
 
-#include <QNetworkReply>
-
+#include "appconfig.h"
 #include "helpers/netman.h"
-#include "helpers/cleanupreply.h"
 
 
 TagCache::TagCache(QObject *parent): QObject(parent) {
 
 }
 
-TagCache::~TagCache() {
-  for (auto entry : std::as_const(tagRequests)) {
-    cleanUpReply(&(entry));
-  }
+qint64 TagCache::expiryMs() {
+  bool ok = false;
+  auto seconds = AppConfig::value(CONFIG::TAG_CACHE_EXPIRY).toLongLong(&ok);
+  return (ok && seconds >= 0) ? seconds * 1000 : TagCacheItem::defaultExpiryDeltaMs;
 }
 
 void TagCache::requestExpiry(QString operationSlug) {
@@ -23,18 +21,47 @@ void TagCache::requestExpiry(QString operationSlug) {
   }
 }
 
+void TagCache::prefetch(const QString& operationSlug) {
+  if (operationSlug.isEmpty()) {
+    return;
+  }
+  auto entry = cache.find(operationSlug);
+  if (entry == cache.end() || entry->isStale()) {
+    requestTags(operationSlug);
+  }
+}
+
+void TagCache::addTag(const QString& operationSlug, const dto::Tag& tag) {
+  auto entry = cache.find(operationSlug);
+  if (entry == cache.end()) {
+    return; // the next lookup will include it
+  }
+  entry->addTag(tag);
+  Q_EMIT tagResponse(operationSlug, entry->getTags());
+}
+
 void TagCache::requestTags(QString operationSlug) {
   auto entry = cache.find(operationSlug);
 
+  if (entry == cache.end()) { // show the tags from the last lookup (if any) while refreshing them
+    auto stored = NetMan::storedOperationTags(operationSlug);
+    if (stored.ok) {
+      auto item = TagCacheItem();
+      item.setTags(dto::Tag::parseDataAsList(stored.body));
+      item.expire();
+      entry = cache.insert(operationSlug, item);
+      Q_EMIT tagResponse(operationSlug, entry->getTags());
+    }
+  }
+
   if (entry == cache.end() || entry->isStale()) { // not found/expired
     if (tagRequests.find(operationSlug) != tagRequests.end()) { // message is in progress -- ignore this request
       return;
     }
 
-    auto reply = NetMan::getOperationTags(operationSlug);
-    tagRequests.insert(operationSlug, reply);
-    connect(reply, &QNetworkReply::finished, this, [this, reply, operationSlug]() {
-      onGetTagsComplete(reply, operationSlug);
+    tagRequests.insert(operationSlug);
+    NetMan::getOperationTags(operationSlug).then(this, [this, operationSlug](const NetMan::CachedResponse& response) {
+      onGetTagsComplete(response, operationSlug);
       tagRequests.remove(operationSlug);
 
       // if successful, alert that new tags are ready!
@@ -57,21 +84,16 @@ void TagCache::requestTags(QString operationSlug) {
   }
 }
 
-void TagCache::onGetTagsComplete(QNetworkReply* reply, QString operationSlug) {
-  bool isValid;
-  auto data = NetMan::extractResponse(reply, isValid);
-
-  if (isValid) {
-    QList<dto::Tag> tags = dto::Tag::parseDataAsList(data);
-    auto item = TagCacheItem();
-    item.setTags(tags);
-    cache[operationSlug] = item;
-  }
-  else {
-    if (cache.find(operationSlug) == cache.end()) {
-
-    }
-  }
+void TagCache::onGetTagsComplete(const NetMan::CachedResponse& response, QString operationSlug) {
+  if (!response.ok)
+    return;
 
-  cleanUpReply(&reply);
+  auto item = TagCacheItem();
+  auto existing = cache.find(operationSlug);
+  // an unchanged list only needs its expiry renewed, not another parse
+  if (response.notModified && existing != cache.end())
+    item.setTags(existing->getTags(), expiryMs());
+  else
+    item.setTags(dto::Tag::parseDataAsList(response.body), expiryMs());
+  cache[operationSlug] = item;
 }
@@ -2,31 +2,50 @@
 
 #include <QObject>
 #include <QMap>
+#include <QSet>
 
 #include "tagcacheitem.h"
 #include "dtos/tag.h"
-
-class QNetworkReply;
-
+#include "helpers/netman.h"
+
+/**
+ * @brief The TagCache class holds the tags of each operation, shared by every TagEditor. Results
+ * are broadcast (via tagResponse / failedLookup), so all open editors update together, whichever
+ * one asked. Tags are current for CONFIG::TAG_CACHE_EXPIRY seconds, after which they are looked up
+ * again.
+ */
 class TagCache : public QObject {
   Q_OBJECT
  public:
-  TagCache(QObject *parent =nullptr);
-  ~TagCache();
+  static TagCache* get() {
+    static TagCache instance;
+    return &instance;
+  }
 
  public:
  signals:
   void tagResponse(QString operationSlug, QList<dto::Tag> tags);
   void failedLookup(QString operationSlug, QList<dto::Tag> oldTags=QList<dto::Tag>());
 
- private slots:
-  void onGetTagsComplete(QNetworkReply* reply, QString operationSlug);
-
  public:
   void requestTags(QString operationSlug);
   void requestExpiry(QString operationSlug);
+  /// prefetch looks up the tags for operationSlug in the background, unless they are already current
+  void prefetch(const QString& operationSlug);
+  /// addTag records a newly created tag, so that every editor for the operation offers it
+  void addTag(const QString& operationSlug, const dto::Tag& tag);
+  /// expiryMs returns how long (in ms) looked up tags are considered current
+  static qint64 expiryMs();
 
  private:
-  QMap<QString , QNetworkReply*> tagRequests;
+  TagCache(QObject *parent =nullptr);
+  ~TagCache() = default;
+  TagCache(TagCache const &) = delete;
+  void operator=(TagCache const &) = delete;
+
+  void onGetTagsComplete(const NetMan::CachedResponse& response, QString operationSlug);
+
+  /// tagRequests holds the operations with a lookup in progress
+  QSet<QString> tagRequests;
   QMap<QString, TagCacheItem> cache;
 };
@@ -19,9 +19,13 @@ qint64 TagCacheItem::now() {
   return QDateTime::currentMSecsSinceEpoch();
 }
 
-void TagCacheItem::setTags(QList<dto::Tag> tags) {
+void TagCacheItem::setTags(QList<dto::Tag> tags, qint64 expiryDeltaMs) {
   this->tags = tags;
-  expiry = now() + defaultExpiryDeltaMs;
+  expiry = now() + expiryDeltaMs;
+}
+
+void TagCacheItem::addTag(const dto::Tag& tag) {
+  tags.append(tag);
 }
 
 QList<dto::Tag> TagCacheItem::getTags() {
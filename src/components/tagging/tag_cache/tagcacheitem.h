@@ -10,14 +10,19 @@ class TagCacheItem
  public:
   void expire();
   bool isStale();
-  void setTags(QList<dto::Tag> tags);
+  /// setTags replaces the tags, which are then current for expiryDeltaMs
+  void setTags(QList<dto::Tag> tags, qint64 expiryDeltaMs = defaultExpiryDeltaMs);
+  /// addTag adds a single tag, without changing when the tags expire
+  void addTag(const dto::Tag& tag);
   QList<dto::Tag> getTags();
 
  private:
   qint64 now();
 
- private:
+ public:
   inline static const qint64 defaultExpiryDeltaMs = 60000;
+
+ private:
   qint64 expiry = 0;
   QList<dto::Tag> tags;
 };
@@ -0,0 +1,175 @@
+#include "tagcompletionmodel.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+TagCompletionModel::TagCompletionModel(QObject *parent)
+  : QAbstractListModel(parent)
+{ }
+
+int TagCompletionModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : static_cast<int>(_rows.size());
+}
+
+QVariant TagCompletionModel::data(const QModelIndex &index, int role) const {
+  if (!index.isValid() || index.row() >= _rows.size())
+    return QVariant();
+  if (role == Qt::DisplayRole || role == Qt::EditRole)
+    return _names.at(_rows.at(index.row()));
+  return QVariant();
+}
+
+void TagCompletionModel::setTags(const QStringList &names) {
+  beginResetModel();
+  _names = names;
+  _names.removeDuplicates();
+  _names.sort(Qt::CaseInsensitive);
+
+  _folded.clear();
+  _folded.reserve(_names.size());
+  _usage.clear();
+  _usage.reserve(_names.size());
+  _trigrams.clear();
+  for (int i = 0; i < _names.size(); i++) {
+    auto folded = _names.at(i).toCaseFolded();
+    const QChar *chars = folded.constData();
+    for (qsizetype j = 0; j + 3 <= folded.size(); j++) {
+      auto &postings = _trigrams[trigramKey(chars + j)];
+      // names are visited in order, so each list stays sorted (and only needs a check for repeats)
+      if (postings.isEmpty() || postings.last() != i)
+        postings.append(i);
+    }
+    _usage.append(_sharedUsage.value(folded));
+    _folded.append(std::move(folded));
+  }
+  _rows = filteredRows(_filter);
+  endResetModel();
+}
+
+void TagCompletionModel::setFilter(const QString &text) {
+  if (text == _filter)
+    return;
+  beginResetModel();
+  _filter = text;
+  _rows = filteredRows(_filter);
+  endResetModel();
+}
+
+void TagCompletionModel::noteUsed(const QString &name) {
+  const auto folded = name.trimmed().toCaseFolded();
+  auto &usage = _sharedUsage[folded];
+  usage.count++;
+  usage.lastUsed = ++_usageClock;
+
+  auto found = _folded.indexOf(folded);
+  if (found >= 0)
+    _usage[found] = usage;
+}
+
+QList<int> TagCompletionModel::filteredRows(const QString &text) const {
+  const auto query = text.trimmed().toCaseFolded();
+  QList<int> rtn;
+  if (query.isEmpty()) {
+    rtn.resize(_names.size());
+    std::iota(rtn.begin(), rtn.end(), 0);
+    return rtn;
+  }
+
+  QList<Match> matches;
+  auto addIfContains = [this, &query, &matches](int tag) {
+    const auto &folded = _folded.at(tag);
+    auto pos = folded.indexOf(query);
+    if (pos < 0)
+      return;
+    auto tier = (pos == 0) ? PREFIX : folded.at(pos - 1).isLetterOrNumber() ? SUBSTRING : WORD_START;
+    matches.append({tag, tier, 0});
+  };
+
+  if (query.size() < 3) {
+    // too short to have a trigram, but then most names are a match anyway
+    for (int i = 0; i < _folded.size(); i++)
+      addIfContains(i);
+    rank(matches);
+  }
+  else {
+    QList<const QList<int> *> postings;
+    QList<quint64> seen;
+    bool allFound = true;
+    for (qsizetype j = 0; j + 3 <= query.size(); j++) {
+      auto key = trigramKey(query.constData() + j);
+      if (seen.contains(key))
+        continue;
+      seen.append(key);
+      auto found = _trigrams.constFind(key);
+      if (found == _trigrams.cend())
+        allFound = false;
+      else
+        postings.append(&found.value());
+    }
+    std::sort(postings.begin(), postings.end(),
+              [](const QList<int> *a, const QList<int> *b) { return a->size() < b->size(); });
+
+    // a name containing the query contains each of its trigrams, so intersect, smallest list first
+    if (allFound && !postings.isEmpty()) {
+      QList<int> candidates = *postings.first();
+      QList<int> narrowed;
+      for (int i = 1; i < postings.size() && !candidates.isEmpty(); i++) {
+        narrowed.clear();
+        std::set_intersection(candidates.cbegin(), candidates.cend(), postings.at(i)->cbegin(),
+                              postings.at(i)->cend(), std::back_inserter(narrowed));
+        candidates.swap(narrowed);
+      }
+      // sharing the trigrams is not enough on its own (e.g. "abcd" has those of "abcabc")
+      for (int tag : std::as_const(candidates))
+        addIfContains(tag);
+    }
+
+    if (matches.size() < maxResults) {
+      const int needed = std::max(1, static_cast<int>((seen.size() + 1) / 2));
+      std::vector<int> shared(_names.size(), 0);
+      for (const auto &match : std::as_const(matches))
+        shared[match.tag] = -static_cast<int>(seen.size());  // already matched; never reaches needed
+      QList<int> fuzzy;
+      for (const auto *list : std::as_const(postings)) {
+        for (int tag : *list) {
+          if (++shared[tag] == needed)
+            fuzzy.append(tag);
+        }
+      }
+      for (int tag : std::as_const(fuzzy))
+        matches.append({tag, FUZZY, shared[tag]});
+    }
+    rank(matches);
+  }
+
+  rtn.reserve(matches.size());
+  for (const auto &match : std::as_const(matches))
+    rtn.append(match.tag);
+  return rtn;
+}
+
+void TagCompletionModel::rank(QList<Match> &matches) const {
+  auto better = [this](const Match &a, const Match &b) {
+    if (a.tier != b.tier)
+      return a.tier < b.tier;
+    if (a.shared != b.shared)
+      return a.shared > b.shared;
+    const auto &aUsage = _usage.at(a.tag);
+    const auto &bUsage = _usage.at(b.tag);
+    if (aUsage.count != bUsage.count)
+      return aUsage.count > bUsage.count;
+    if (aUsage.lastUsed != bUsage.lastUsed)
+      return aUsage.lastUsed > bUsage.lastUsed;
+    return a.tag < b.tag;  // i.e. alphabetically
+  };
+
+  // only the shown results need to be in order
+  if (matches.size() > maxResults) {
+    std::partial_sort(matches.begin(), matches.begin() + maxResults, matches.end(), better);
+    matches.resize(maxResults);
+  }
+  else {
+    std::sort(matches.begin(), matches.end(), better);
+  }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QStringList>
+
+/**
+ * @brief The TagCompletionModel class provides the (ranked) tag names matching the text typed so
+ * far, for use with a QCompleter in UnfilteredPopupCompletion mode. The model does its own
+ * filtering (see setFilter), since QCompleter's filtering is a substring scan of every name, on
+ * every keystroke, which does not hold up for operations with thousands of tags.
+ *
+ * Names are indexed by trigram (every 3 character run, case folded), so a query only examines the
+ * names sharing all of its trigrams. Matches are ranked prefix first, then word start, then
+ * anywhere in the name. If that leaves room, names sharing at least half of the query's trigrams
+ * are included last, to allow for typos. Within each rank, tags used more often (then more
+ * recently) come first.
+ */
+class TagCompletionModel : public QAbstractListModel {
+  Q_OBJECT
+ public:
+  /// maxResults is the most names shown for a (non-empty) filter
+  inline static const int maxResults = 100;
+
+  explicit TagCompletionModel(QObject *parent = nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+  /// setTags replaces the names offered (and rebuilds the index), keeping the current filter
+  void setTags(const QStringList &names);
+  /// setFilter limits the rows to the names matching text. An empty text shows every name.
+  void setFilter(const QString &text);
+  [[nodiscard]] QString filter() const { return _filter; }
+  /// noteUsed records that the named tag was picked, so that it ranks higher from now on (in
+  /// every model)
+  void noteUsed(const QString &name);
+
+ private:
+  enum MatchTier {
+    PREFIX = 0,
+    WORD_START,
+    SUBSTRING,
+    FUZZY,
+  };
+
+  struct Usage {
+    int count = 0;
+    quint64 lastUsed = 0;
+  };
+
+  struct Match {
+    int tag;
+    MatchTier tier;
+    /// shared is the number of query trigrams found in the name (used to rank FUZZY matches)
+    int shared;
+  };
+
+  static quint64 trigramKey(const QChar *c) {
+    return (quint64(c[0].unicode()) << 32) | (quint64(c[1].unicode()) << 16) | c[2].unicode();
+  }
+
+  QList<int> filteredRows(const QString &text) const;
+  void rank(QList<Match> &matches) const;
+
+  /// _names are the tag names, sorted case insensitively. Tags are referred to by index into this.
+  QStringList _names;
+  /// _folded holds the case folded version of each name
+  QStringList _folded;
+  /// _usage holds the usage of each name
+  QList<Usage> _usage;
+  /// _trigrams maps each trigram to the (ascending) indexes of the names that contain it
+  QHash<quint64, QList<int>> _trigrams;
+
+  QString _filter;
+  /// _rows holds the indexes of the names currently shown, in display order
+  QList<int> _rows;
+
+  /// _sharedUsage holds the usage of each tag name (case folded), across all models
+  inline static QHash<QString, Usage> _sharedUsage;
+  inline static quint64 _usageClock = 0;
+};
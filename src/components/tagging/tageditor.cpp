@@ -6,7 +6,6 @@
 #include <QNetworkReply>
 #include <QLineEdit>
 #include <QMessageBox>
-#include <QStringListModel>
 #include <QTimer>
 #include <algorithm>
 
@@ -14,6 +13,7 @@
 #include "helpers/netman.h"
 #include "helpers/cleanupreply.h"
 #include "tag_cache/tagcache.h"
+#include "tagcompletionmodel.h"
 
 TagEditor::TagEditor(QWidget *parent)
   : QWidget(parent)
@@ -21,8 +21,8 @@ TagEditor::TagEditor(QWidget *parent)
   , errorLabel(new QLabel(this))
   , loading(new QProgressIndicator(this))
   , completer(new QCompleter(this))
+  , completionModel(new TagCompletionModel(this))
   , tagCompleteTextBox(new QLineEdit(this))
-  , tagCache(new TagCache(this))
 {
   buildUi();
   wireUi();
@@ -36,9 +36,9 @@ TagEditor::~TagEditor() {
 }
 
 void TagEditor::buildUi() {
-  completer->setCompletionMode(QCompleter::PopupCompletion);
-  completer->setFilterMode(Qt::MatchContains);
-  completer->setCaseSensitivity(Qt::CaseInsensitive);
+  // completionModel does the filtering (as the user types), so the completer shows it as-is
+  completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+  completer->setModel(completionModel);
 
   tagCompleteTextBox->setPlaceholderText("Add Tags...");
   tagCompleteTextBox->installEventFilter(&filter);
@@ -78,11 +78,18 @@ void TagEditor::wireUi() {
   connect(tagCompleteTextBox, &QLineEdit::textChanged, this, [this](const QString &text) {
     if (text.isEmpty()) {
       tagCompleteTextBox->completer()->setCompletionPrefix(QString());
+      completionModel->setFilter(QString());
+    }
+  });
+  connect(tagCompleteTextBox, &QLineEdit::textEdited, this, [this](const QString &text) {
+    completionModel->setFilter(text);
+    if (!text.isEmpty()) {
+      showCompleter();
     }
   });
 
-  connect(tagCache, &TagCache::tagResponse, this, &TagEditor::tagsUpdated);
-  connect(tagCache, &TagCache::failedLookup, this, &TagEditor::tagsNotFound);
+  connect(TagCache::get(), &TagCache::tagResponse, this, &TagEditor::tagsUpdated);
+  connect(TagCache::get(), &TagCache::failedLookup, this, &TagEditor::tagsNotFound);
 }
 
 void TagEditor::completerActivated(const QString &text) {
@@ -108,6 +115,7 @@ void TagEditor::tagTextEntered(QString text) {
   }
   else {
     dto::Tag data = foundTag.value();
+    completionModel->noteUsed(data.name);
     tagView->contains(data) ? tagView->remove(data) : tagView->addTag(data);
   }
 
@@ -116,10 +124,7 @@ void TagEditor::tagTextEntered(QString text) {
 }
 
 void TagEditor::updateCompleterModel() {
-  tagNames.sort(Qt::CaseInsensitive);
-  // no need to delete previous model -- handled by qcompleter
-  completer->setModel(new QStringListModel(tagNames, completer));
-  completer->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
+  completionModel->setTags(tagNames);
 }
 
 void TagEditor::clear() {
@@ -132,12 +137,21 @@ void TagEditor::clear() {
 void TagEditor::loadTags(const QString &operationSlug, QList<model::Tag> initialTags) {
   this->operationSlug = operationSlug;
   this->initialTags = initialTags;
+  tagsShown = false;
 
-  tagCache->requestTags(operationSlug);
+  TagCache::get()->requestTags(operationSlug);
 }
 
 void TagEditor::tagsUpdated(QString operationSlug, QList<dto::Tag> tags) {
   if (this->operationSlug == operationSlug) {
+    const bool refreshing = tagsShown;
+    if (refreshing) {
+      // the (stored) tags are already showing; keep what the user has picked since then
+      if (matchesKnownTags(tags))
+        return;
+      initialTags = tagView->getIncludedTags();
+      tagView->clear();
+    }
     clearTags();
     for (const auto& tag : tags) {
       addTag(tag);
@@ -150,12 +164,18 @@ void TagEditor::tagsUpdated(QString operationSlug, QList<dto::Tag> tags) {
       }
     }
     updateCompleterModel();
-    Q_EMIT tagsLoaded(true);
+    tagsShown = true;
+    if (!refreshing)
+      Q_EMIT tagsLoaded(true);
   }
 }
 
 void TagEditor::tagsNotFound(QString operationSlug, QList<dto::Tag> outdatedTags) {
   if (this->operationSlug == operationSlug) {
+    if (tagsShown) { // the stored tags remain usable, they just may be out of date
+      errorLabel->setText(tr("Unable to refresh tags. (Recently added tags may be missing)"));
+      return;
+    }
     errorLabel->setText(
         tr("Unable to fetch tags."
            " Please check your connection."
@@ -190,7 +210,7 @@ void TagEditor::onCreateTagComplete() {
     auto newTag = dto::Tag::parseData(data);
     addTag(newTag);
     tagView->addTag(newTag);
-    tagCache->requestExpiry(this->operationSlug);
+    TagCache::get()->addTag(this->operationSlug, newTag);
     updateCompleterModel();
   }
   else {
@@ -208,6 +228,16 @@ void TagEditor::addTag(dto::Tag tag) {
   tagMap.insert(standardizeTagKey(tag.name), tag);
 }
 
+bool TagEditor::matchesKnownTags(const QList<dto::Tag>& tags) {
+  if (tags.size() != tagMap.size())
+    return false;
+  return std::all_of(tags.cbegin(), tags.cend(), [this](const dto::Tag& tag) {
+    auto known = tagMap.constFind(standardizeTagKey(tag.name));
+    return known != tagMap.cend() && known->id == tag.id && known->name == tag.name
+           && known->colorName == tag.colorName;
+  });
+}
+
 void TagEditor::clearTags() {
   tagNames.clear();
   tagMap.clear();
@@ -12,7 +12,7 @@
 class QNetworkReply;
 class QProgressIndicator;
 class QLineEdit;
-class TagCache;
+class TagCompletionModel;
 
 class TagEditor : public QWidget {
   Q_OBJECT
@@ -30,6 +30,8 @@ class TagEditor : public QWidget {
   inline void showCompleter() { completer->complete(); }
   void addTag(dto::Tag tag);
   void clearTags();
+  /// matchesKnownTags returns true if tags are exactly the tags currently offered
+  bool matchesKnownTags(const QList<dto::Tag>& tags);
   QString standardizeTagKey(const QString &tagName);
 
  private slots:
@@ -52,13 +54,16 @@ class TagEditor : public QWidget {
  private:
   QString operationSlug;
   QList<model::Tag> initialTags;
+  /// tagsShown is true once tags have been shown for operationSlug (possibly from a stored lookup,
+  /// with a refresh still to come)
+  bool tagsShown = false;
 
   QNetworkReply* createTagReply = nullptr;
   QMap<QString, QNetworkReply*> activeRequests;
-  TagCache* tagCache = nullptr;
 
   TaggingLineEditEventFilter filter;
   QCompleter* completer;
+  TagCompletionModel* completionModel = nullptr;
   QStringList tagNames;
   QMap<QString, dto::Tag> tagMap;
 
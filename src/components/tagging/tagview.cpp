@@ -83,6 +83,7 @@ QList<model::Tag> TagView::getIncludedTags() {
 }
 
 void TagView::setReadonly(bool readonly) {
+  this->readonly = readonly; // so that tags added later (e.g. on refresh) match
   for(auto widget : includedTags) {
     widget->setReadOnly(readonly);
   }
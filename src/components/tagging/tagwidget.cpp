@@ -1,6 +1,7 @@
 #include "tagwidget.h"
 
 #include <QPainter>
+#include <QPixmapCache>
 #include <QMouseEvent>
 #include <iostream>
 
@@ -13,10 +14,29 @@ TagWidget::TagWidget(dto::Tag tag, bool readonly, QWidget *parent)
 }
 
 void TagWidget::setReadOnly(bool readonly) {
+  if (this->readonly == readonly) {
+    return;
+  }
   this->readonly = readonly;
   buildTag();
 }
 
+const QFont& TagWidget::labelFont() {
+#ifdef Q_OS_MACOS
+  static const QFont font(QStringLiteral("Arial"), 14);
+#elif defined(Q_OS_LINUX)
+  static const QFont font(QStringLiteral("Liberation Sans"), 12);
+#else
+  static const QFont font(QStringLiteral("Sans"), 12);
+#endif
+  return font;
+}
+
+const QFontMetrics& TagWidget::labelMetrics() {
+  static const QFontMetrics metrics(labelFont());
+  return metrics;
+}
+
 void TagWidget::mouseReleaseEvent(QMouseEvent* evt) {
   const int x = evt->position().x();
   const int y = evt->position().y();
@@ -30,17 +50,8 @@ void TagWidget::mouseReleaseEvent(QMouseEvent* evt) {
 }
 
 void TagWidget::buildTag() {
-  QFont labelFont;
-#ifdef Q_OS_MACOS
-  labelFont = QFont("Arial", 14);
-#elif defined(Q_OS_LINUX)
-  labelFont = QFont("Liberation Sans", 12);
-#else
-  labelFont = QFont("Sans", 12);
-#endif
-
   // Calculate the positions of everything
-  QFontMetrics metric(labelFont);
+  const auto& metric = labelMetrics();
   QSize labelSize = metric.size(Qt::TextSingleLine, tag.name);
   QSize removeSize = metric.size(Qt::TextSingleLine, removeSymbol);
 
@@ -64,8 +75,18 @@ void TagWidget::buildTag() {
 
   const qreal dpr = this->devicePixelRatio();
 
+  // identical tags (e.g. the same tags, seen on each evidence) render identically, so only draw once
+  const auto cacheKey = QStringLiteral("tag:%1:%2:%3:%4")
+      .arg(tag.colorName, readonly ? QStringLiteral("ro") : QStringLiteral("rw"),
+           QString::number(dpr), tag.name);
+  QPixmap pixmap;
+  if (QPixmapCache::find(cacheKey, &pixmap)) {
+    setPixmap(pixmap);
+    return;
+  }
+
   // prep the image
-  QPixmap pixmap = QPixmap(fullTagWidth * dpr, fullTagHeight * dpr);
+  pixmap = QPixmap(fullTagWidth * dpr, fullTagHeight * dpr);
   pixmap.setDevicePixelRatio(dpr);
   pixmap.fill(Qt::transparent);
 
@@ -81,7 +102,7 @@ void TagWidget::buildTag() {
 
   // set up font drawing
   auto fontColor = fontColorForBgColor(bgColor);
-  painter.setFont(labelFont);
+  painter.setFont(labelFont());
   painter.setPen(fontColor);
 
   // draw label
@@ -93,5 +114,6 @@ void TagWidget::buildTag() {
   }
   painter.end();
 
+  QPixmapCache::insert(cacheKey, pixmap);
   setPixmap(pixmap);
 }
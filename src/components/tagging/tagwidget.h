@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QFont>
+#include <QFontMetrics>
 #include <QImage>
 #include <QLabel>
 #include <QWidget>
@@ -16,6 +18,10 @@ class TagWidget : public QLabel {
 
  private:
   void buildTag();
+  /// labelFont returns the font used to draw tag names (created once)
+  static const QFont& labelFont();
+  /// labelMetrics returns the metrics for labelFont (created once)
+  static const QFontMetrics& labelMetrics();
   //void setImage(QImage img);
 
  protected:
@@ -1,9 +1,14 @@
 #include "databaseconnection.h"
 
 #include <QDir>
-#include <QTimeZone>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
 #include <QVariant>
 
+#include "dbtransaction.h"
+#include "evidencecursor.h"
+#include "migrationinfo.h"
 #include "helpers/file_helpers.h"
 
 DatabaseConnection::DatabaseConnection(const QString& dbPath, const QString& databaseName)
@@ -15,116 +20,405 @@ DatabaseConnection::DatabaseConnection(const QString& dbPath, const QString& dat
     if(!QDir().exists(dbDir))
         QDir().mkpath(dbDir);
     _db.setDatabaseName(_dbPath);
+    _db.setConnectOptions(QStringLiteral("QSQLITE_BUSY_TIMEOUT=%1").arg(_busyTimeoutMs));
 }
 
 bool DatabaseConnection::withConnection(const QString& dbPath, const QString &dbName,
-                                        const std::function<void(DatabaseConnection)> &actions)
+                                        const std::function<void(DatabaseConnection&)> &actions)
 {
-    DatabaseConnection conn(dbPath, dbName);
-    if(!conn.connect())
-        return false;
-    actions(conn);
-    bool rtn = true;
-    if(conn._db.lastError().isValid())
-        rtn = false;
-
-    conn.close();
-    QSqlDatabase::removeDatabase(dbPath);
+    bool rtn = false;
+    {
+        // scoped so that the connection (and its prepared statements) are released before the
+        // connection is removed. Otherwise Qt will complain that the connection is still in use.
+        DatabaseConnection conn(dbPath, dbName);
+        if (conn.connect()) {
+            actions(conn);
+            rtn = !conn._db.lastError().isValid();
+        }
+        conn.close();
+    }
+    QSqlDatabase::removeDatabase(dbName);
     return rtn;
 }
 
 bool DatabaseConnection::connect()
 {
+    QElapsedTimer timer;
+    timer.start();
     if (!_db.open())
         return false;
+    qInfo() << "Opened database" << _dbName << "in" << timer.elapsed() << "ms";
     return migrateDB();
 }
 
-qint64 DatabaseConnection::createEvidence(const QString &filepath, const QString &operationSlug, const QString &contentType)
+bool DatabaseConnection::useWriteAheadLog()
+{
+    auto result = executeQueryNoThrow(_db, QStringLiteral("PRAGMA journal_mode=WAL"));
+    if (!result.success || !result.query.next()
+        || result.query.value(0).toString().compare(QStringLiteral("wal"), Qt::CaseInsensitive) != 0) {
+        qWarning() << "Unable to enable write-ahead logging: " << result.err.text();
+        return false;
+    }
+    // NORMAL is durable across application crashes in WAL mode, and avoids an fsync per commit
+    return executeQueryNoThrow(_db, QStringLiteral("PRAGMA synchronous=NORMAL")).success;
+}
+
+void DatabaseConnection::close() noexcept
 {
-    auto qKeys = QStringLiteral("path, operation_slug, content_type, recorded_date");
-    auto qValues = QStringLiteral("?, ?, ?, datetime('now')");
+    // prepared statements hold on to the underlying connection, so they need to go first
+    _statementCache.clear();
+    _db.close();
+}
+
+qint64 DatabaseConnection::createEvidence(const QString &filepath, const QString &operationSlug,
+                                          const QString &contentType, const QString &contentText,
+                                          const QString &contentHash)
+{
+    auto qKeys = QStringLiteral("path, operation_slug, content_type, content_text, content_hash, recorded_date");
+    auto qValues = QStringLiteral("?, ?, ?, ?, ?, datetime('now')");
     auto qStr = _sqlBasicInsert.arg(_tblEvidence, qKeys, qValues);
-    return doInsert(_db, qStr, {filepath, operationSlug, contentType});
+    return doCachedInsert(qStr, {filepath, operationSlug, contentType, contentText, contentHash});
 }
 
 qint64 DatabaseConnection::createFullEvidence(const model::Evidence &evidence) {
-    auto qKeys = QStringLiteral("path, operation_slug, content_type, description, error, recorded_date, upload_date");
-    auto qValues = QStringLiteral("?, ?, ?, ?, ?, ?, ?");
+    auto qKeys = QStringLiteral("path, operation_slug, content_type, description, error, recorded_date, upload_date, content_text, content_hash");
+    auto qValues = QStringLiteral("?, ?, ?, ?, ?, ?, ?, ?, ?");
     auto qStr = _sqlBasicInsert.arg(_tblEvidence, qKeys, qValues);
-    return doInsert(_db, qStr,
+    return doCachedInsert(qStr,
                   {evidence.path, evidence.operationSlug, evidence.contentType, evidence.description,
-                   evidence.errorText, evidence.recordedDate, evidence.uploadDate});
+                   evidence.errorText, evidence.recordedDate, evidence.uploadDate, evidence.contentText,
+                   evidence.contentHash});
 }
 
-void DatabaseConnection::batchCopyFullEvidence(const QList<model::Evidence> &evidence) {
-  auto baseQuery = QStringLiteral("INSERT INTO evidence (%1) VALUES %2").arg(_evidenceAllKeys, QStringLiteral("%1"));
-  int varsPerRow = 8; // count number of "?"
-  std::function<QVariantList(int)> getItemValues = [evidence](int i){
-    auto item = evidence.at(i);
-    return QVariantList {
-        item.id, item.path, item.operationSlug, item.contentType, item.description,
-        item.errorText, item.recordedDate, item.uploadDate
-    };
-  };
-  batchInsert(baseQuery, varsPerRow, evidence.size(), getItemValues);
+bool DatabaseConnection::batchCopyFullEvidence(const QList<model::Evidence> &evidence) {
+  auto rowQuery = _sqlBasicInsert.arg(_tblEvidence, _evidenceCopyKeys, QStringLiteral("?, ?, ?, ?, ?, ?, ?, ?, ?, ?"));
+  QList<QVariantList> columns(EvidenceMapper::columnCount + 1);
+  for (auto &column : columns)
+    column.reserve(evidence.size());
+  for (const auto &item : evidence) {
+    columns[0].append(item.id);
+    columns[1].append(item.path);
+    columns[2].append(item.operationSlug);
+    columns[3].append(item.contentType);
+    columns[4].append(item.description);
+    columns[5].append(item.errorText);
+    columns[6].append(item.recordedDate);
+    columns[7].append(item.uploadDate);
+    columns[8].append(item.contentHash);
+    columns[9].append(item.contentText);
+  }
+  return batchInsertColumns(rowQuery, columns);
 }
 
-
 model::Evidence DatabaseConnection::getEvidenceDetails(qint64 evidenceID)
 {
   model::Evidence rtn;
-  auto qStr = QStringLiteral("%1 WHERE id=? LIMIT 1").arg(_sqlSelectTemplate.arg(_evidenceAllKeys, _tblEvidence));
-  auto query = executeQuery(_db, qStr, {evidenceID});
-  if (!_db.lastError().isValid() && query.first()) {
-    rtn.id = query.value(QStringLiteral("id")).toLongLong();
-    rtn.path = query.value(QStringLiteral("path")).toString();
-    rtn.operationSlug = query.value(QStringLiteral("operation_slug")).toString();
-    rtn.contentType = query.value(QStringLiteral("content_type")).toString();
-    rtn.description = query.value(QStringLiteral("description")).toString();
-    rtn.errorText = query.value(QStringLiteral("error")).toString();
-    rtn.recordedDate = query.value(QStringLiteral("recorded_date")).toDateTime();
-    rtn.uploadDate = query.value(QStringLiteral("upload_date")).toDateTime();
-    rtn.recordedDate.setTimeZone(QTimeZone::UTC);
-    rtn.uploadDate.setTimeZone(QTimeZone::UTC);
-    rtn.tags = getTagsForEvidenceID(evidenceID);
-  } else {
-    rtn.id = -1;
-  }
+  rtn.id = -1;
+  auto qStr = QStringLiteral("%1 WHERE id=? LIMIT 1").arg(_sqlSelectTemplate.arg(_evidenceWithTagsKeys, _tblEvidence));
+  executeCachedQuery(qStr, {evidenceID}, [&rtn](const QSqlQuery& query) {
+    rtn = decodeEvidence(query, true);
+  });
   return rtn;
 }
 
+QList<model::Evidence> DatabaseConnection::getEvidenceDetails(const QList<qint64> &evidenceIDs)
+{
+  QList<model::Evidence> allEvidence;
+  allEvidence.reserve(evidenceIDs.size());
+  auto baseQuery = QStringLiteral("%1 WHERE id IN (%2)")
+                       .arg(_sqlSelectTemplate.arg(_evidenceWithTagsKeys, _tblEvidence), QStringLiteral("%1"));
+  batchQuery(baseQuery, 1, evidenceIDs.size(),
+      [evidenceIDs](unsigned int index){
+        return QVariantList{evidenceIDs[index]};
+      },
+      [&allEvidence](const QSqlQuery& resultItem){
+        allEvidence.append(decodeEvidence(resultItem, true));
+      });
+  return allEvidence;
+}
+
+model::Evidence DatabaseConnection::decodeEvidence(const QSqlQuery &query, bool includesTags)
+{
+  model::Evidence evi = EvidenceMapper::read(query);
+  if (!includesTags)
+    return evi;
+
+  // the tags column directly follows the evidence columns (see _evidenceWithTagsKeys)
+  // json_group_array yields "[]" when there are no tags, so every row decodes to an array
+  const auto tagRows = QJsonDocument::fromJson(query.value(EvidenceMapper::columnCount).toByteArray()).array();
+  evi.tags.reserve(tagRows.size());
+  for (const auto &tagRow : tagRows) {
+    const auto cols = tagRow.toArray();
+    evi.tags.append(model::Tag(cols.at(0).toInteger(), evi.id, cols.at(1).toInteger(),
+                               cols.at(2).toString()));
+  }
+  return evi;
+}
+
 bool DatabaseConnection::updateEvidenceDescription(const QString &newDescription, qint64 evidenceID)
 {
-    auto q = executeQuery(_db, QStringLiteral("UPDATE evidence SET description=? WHERE id=?"), {newDescription, evidenceID});
-    return !q.lastError().isValid();
+    return executeCachedQuery(QStringLiteral("UPDATE evidence SET description=? WHERE id=?"), {newDescription, evidenceID});
 }
 
 bool DatabaseConnection::deleteEvidence(qint64 evidenceID)
 {
-    auto q = executeQuery(_db, QStringLiteral("DELETE FROM evidence WHERE id=?"), {evidenceID});
-    return !q.lastError().isValid();
+    return executeCachedQuery(QStringLiteral("DELETE FROM evidence WHERE id=?"), {evidenceID});
+}
+
+bool DatabaseConnection::deleteEvidence(const QList<qint64> &evidenceIDs,
+                                        QList<model::Evidence> &deleted)
+{
+    deleted.clear();
+    const QVariantList args = {toJsonIDList(evidenceIDs)};
+
+    DBTransaction transaction(this);
+    bool found = executeCachedQuery(
+        QStringLiteral("SELECT id, path, content_hash FROM evidence WHERE id IN (SELECT value FROM json_each(?))"),
+        args, [&deleted](const QSqlQuery& query) {
+      model::Evidence evi{};
+      evi.id = query.value(0).toLongLong();
+      evi.path = query.value(1).toString();
+      evi.contentHash = query.value(2).toString();
+      deleted.append(evi);
+    });
+    if (!found
+        || !transaction.exec(QStringLiteral("DELETE FROM tags WHERE evidence_id IN (SELECT value FROM json_each(?))"), args)
+        || !transaction.exec(QStringLiteral("DELETE FROM evidence WHERE id IN (SELECT value FROM json_each(?))"), args)
+        || !transaction.commit()) {
+        deleted.clear();
+        return false;
+    }
+    return true;
+}
+
+QSet<QString> DatabaseConnection::getEvidencePathsInUse(const QList<model::Evidence> &evidence)
+{
+    QSet<QString> inUse;
+    // files are only shared through the content store, where sharing evidence always shares a hash
+    QJsonArray hashes;
+    for (const auto &evi : evidence) {
+        if (!evi.contentHash.isEmpty())
+            hashes.append(evi.contentHash);
+    }
+    if (hashes.isEmpty())
+        return inUse;
+    QSet<QString> paths;
+    for (const auto &evi : evidence)
+        paths.insert(evi.path);
+    executeCachedQuery(
+        QStringLiteral("SELECT DISTINCT path FROM evidence WHERE content_hash IN (SELECT value FROM json_each(?))"),
+        {QString::fromUtf8(QJsonDocument(hashes).toJson(QJsonDocument::Compact))},
+        [&inUse, &paths](const QSqlQuery& query) {
+      auto path = query.value(0).toString();
+      if (paths.contains(path))
+        inUse.insert(path);
+    });
+    return inUse;
+}
+
+bool DatabaseConnection::enqueueUploads(const QList<qint64> &evidenceIDs, qint64 now,
+                                        QList<qint64> &queuedIDs)
+{
+    using model::UploadState;
+    queuedIDs.clear();
+    // RETURNING only yields the rows inserted or updated, so skipped evidence is left out
+    return executeCachedQuery(
+        QStringLiteral("INSERT INTO upload_queue (evidence_id, state, attempts, next_attempt_at, last_error, queued_at)"
+                       " SELECT id, %1, 0, ?, '', ? FROM evidence"
+                       " WHERE id IN (SELECT value FROM json_each(?)) AND upload_date IS NULL"
+                       " ON CONFLICT (evidence_id) DO UPDATE SET"
+                       " state=excluded.state, attempts=0, next_attempt_at=excluded.next_attempt_at,"
+                       " last_error='', queued_at=excluded.queued_at"
+                       " WHERE upload_queue.state != %2"
+                       " RETURNING evidence_id")
+            .arg(int(UploadState::QUEUED))
+            .arg(int(UploadState::UPLOADING)),
+        {now, now, toJsonIDList(evidenceIDs)}, [&queuedIDs](const QSqlQuery& query) {
+      queuedIDs.append(query.value(0).toLongLong());
+    });
+}
+
+bool DatabaseConnection::resetInterruptedUploads()
+{
+    using model::UploadState;
+    return executeCachedQuery(QStringLiteral("UPDATE upload_queue SET state=%1 WHERE state=%2")
+                                  .arg(int(UploadState::QUEUED))
+                                  .arg(int(UploadState::UPLOADING)));
+}
+
+QList<model::QueuedUpload> DatabaseConnection::claimUploads(int limit, qint64 now)
+{
+    using model::UploadState;
+    QList<model::QueuedUpload> claimed;
+    QHash<qint64, int> attempts;
+    QList<qint64> ids;
+
+    DBTransaction transaction(this);
+    bool found = executeCachedQuery(
+        QStringLiteral("SELECT evidence_id, attempts FROM upload_queue"
+                       " WHERE state=%1 AND next_attempt_at<=?"
+                       " ORDER BY queued_at, evidence_id LIMIT ?").arg(int(UploadState::QUEUED)),
+        {now, limit}, [&attempts, &ids](const QSqlQuery& query) {
+      auto id = query.value(0).toLongLong();
+      ids.append(id);
+      attempts.insert(id, query.value(1).toInt() + 1);
+    });
+    if (!found || ids.isEmpty())
+        return claimed;
+    if (!transaction.exec(QStringLiteral("UPDATE upload_queue SET state=%1, attempts=attempts+1"
+                                         " WHERE evidence_id IN (SELECT value FROM json_each(?))")
+                              .arg(int(UploadState::UPLOADING)),
+                          {toJsonIDList(ids)}))
+        return claimed;
+
+    const auto evidence = getEvidenceDetails(ids);
+    if (!transaction.commit())
+        return claimed;
+    // getEvidenceDetails does not keep the queue order
+    QHash<qint64, model::Evidence> byID;
+    for (const auto &evi : evidence)
+        byID.insert(evi.id, evi);
+    claimed.reserve(byID.size());
+    for (auto id : ids) {
+        auto found = byID.constFind(id);
+        if (found != byID.cend())
+            claimed.append(model::QueuedUpload{found.value(), attempts.value(id)});
+    }
+    return claimed;
+}
+
+qint64 DatabaseConnection::nextUploadAttemptAt()
+{
+    qint64 next = -1;
+    executeCachedQuery(QStringLiteral("SELECT MIN(next_attempt_at) FROM upload_queue WHERE state=%1")
+                           .arg(int(model::UploadState::QUEUED)),
+                       {}, [&next](const QSqlQuery& query) {
+      if (!query.value(0).isNull())
+        next = query.value(0).toLongLong();
+    });
+    return next;
+}
+
+bool DatabaseConnection::completeUpload(qint64 evidenceID)
+{
+    DBTransaction transaction(this);
+    transaction.exec(QStringLiteral("UPDATE evidence SET upload_date=datetime('now') WHERE id=?"), {evidenceID});
+    transaction.exec(QStringLiteral("UPDATE upload_queue SET state=%1, last_error='' WHERE evidence_id=?")
+                         .arg(int(model::UploadState::DONE)),
+                     {evidenceID});
+    return transaction.commit();
+}
+
+bool DatabaseConnection::retryUpload(qint64 evidenceID, const QString &errorText,
+                                     qint64 nextAttemptAt)
+{
+    return executeCachedQuery(
+        QStringLiteral("UPDATE upload_queue SET state=%1, last_error=?, next_attempt_at=? WHERE evidence_id=?")
+            .arg(int(model::UploadState::QUEUED)),
+        {errorText, nextAttemptAt, evidenceID});
+}
+
+bool DatabaseConnection::failUpload(qint64 evidenceID, const QString &errorText)
+{
+    DBTransaction transaction(this);
+    transaction.exec(QStringLiteral("UPDATE evidence SET error=? WHERE id=?"), {errorText, evidenceID});
+    transaction.exec(QStringLiteral("UPDATE upload_queue SET state=%1, last_error=? WHERE evidence_id=?")
+                         .arg(int(model::UploadState::FAILED)),
+                     {errorText, evidenceID});
+    return transaction.commit();
 }
 
 bool DatabaseConnection::updateEvidenceError(const QString &errorText, qint64 evidenceID) {
-  auto q = executeQuery(_db, QStringLiteral("UPDATE evidence SET error=? WHERE id=?"), {errorText, evidenceID});
-  return !q.lastError().isValid();
+  return executeCachedQuery(QStringLiteral("UPDATE evidence SET error=? WHERE id=?"), {errorText, evidenceID});
+}
+
+bool DatabaseConnection::updateEvidenceContentText(const QString &contentText, qint64 evidenceID) {
+  return executeCachedQuery(QStringLiteral("UPDATE evidence SET content_text=? WHERE id=?"), {contentText, evidenceID});
+}
+
+QHash<qint64, QString> DatabaseConnection::getEvidencePathsWithoutContentText(const QString &contentType) {
+  QHash<qint64, QString> paths;
+  executeCachedQuery(QStringLiteral("SELECT id, path FROM evidence WHERE content_type=? AND content_text=''"),
+                     {contentType}, [&paths](const QSqlQuery& query) {
+    paths.insert(query.value(0).toLongLong(), query.value(1).toString());
+  });
+  return paths;
+}
+
+QHash<qint64, QString> DatabaseConnection::getEvidenceContentText(const QList<qint64> &evidenceIDs) {
+  QHash<qint64, QString> contentText;
+  contentText.reserve(evidenceIDs.size());
+  executeCachedQuery(QStringLiteral("SELECT id, content_text FROM evidence WHERE id IN (SELECT value FROM json_each(?))"),
+                     {toJsonIDList(evidenceIDs)}, [&contentText](const QSqlQuery& query) {
+    contentText.insert(query.value(0).toLongLong(), query.value(1).toString());
+  });
+  return contentText;
+}
+
+bool DatabaseConnection::updateEvidenceContentHash(const QString &contentHash, qint64 evidenceID) {
+  return executeCachedQuery(QStringLiteral("UPDATE evidence SET content_hash=? WHERE id=?"), {contentHash, evidenceID});
+}
+
+QHash<qint64, QString> DatabaseConnection::getEvidencePathsWithoutContentHash(qint64 afterEvidenceID,
+                                                                             int limit) {
+  QHash<qint64, QString> paths;
+  executeCachedQuery(
+      QStringLiteral("SELECT id, path FROM evidence WHERE content_hash='' AND id>? ORDER BY id LIMIT ?"),
+      {afterEvidenceID, limit}, [&paths](const QSqlQuery& query) {
+    paths.insert(query.value(0).toLongLong(), query.value(1).toString());
+  });
+  return paths;
+}
+
+qint64 DatabaseConnection::findDuplicateEvidence(const QString &contentHash,
+                                                 const QString &operationSlug,
+                                                 qint64 excludingEvidenceID) {
+  qint64 duplicateID = 0;
+  if (contentHash.isEmpty())
+    return duplicateID;
+  executeCachedQuery(
+      QStringLiteral("SELECT MIN(id) FROM evidence WHERE content_hash=? AND operation_slug=? AND id!=?"),
+      {contentHash, operationSlug, excludingEvidenceID}, [&duplicateID](const QSqlQuery& query) {
+    duplicateID = query.value(0).toLongLong();
+  });
+  return duplicateID;
+}
+
+bool DatabaseConnection::isEvidencePathInUse(const QString &path, const QString &contentHash) {
+  // shared files always share a hash, so the hash index narrows the search
+  bool inUse = false;
+  executeCachedQuery(QStringLiteral("SELECT 1 FROM evidence WHERE content_hash=? AND path=? LIMIT 1"),
+                     {contentHash, path}, [&inUse](const QSqlQuery&) {
+    inUse = true;
+  });
+  return inUse;
 }
 
 void DatabaseConnection::updateEvidenceSubmitted(qint64 evidenceID) {
-  executeQuery(_db, QStringLiteral("UPDATE evidence SET upload_date=datetime('now') WHERE id=?"), {evidenceID});
+  executeCachedQuery(QStringLiteral("UPDATE evidence SET upload_date=datetime('now') WHERE id=?"), {evidenceID});
+}
+
+model::EvidenceStats DatabaseConnection::getEvidenceStats(const QString &operationSlug,
+                                                          const QString &contentType) {
+  model::EvidenceStats stats;
+  // an empty content type matches every type. Either way, the primary key bounds the rows read.
+  executeCachedQuery(
+      QStringLiteral("SELECT pending, failed, submitted FROM evidence_stats"
+                     " WHERE operation_slug=? AND (?='' OR content_type=?)"),
+      {operationSlug, contentType, contentType}, [&stats](const QSqlQuery& query) {
+    stats.pending += query.value(0).toLongLong();
+    stats.failed += query.value(1).toLongLong();
+    stats.submitted += query.value(2).toLongLong();
+  });
+  return stats;
 }
 
 QList<model::Tag> DatabaseConnection::getTagsForEvidenceID(qint64 evidenceID) {
   QList<model::Tag> tags;
-  auto getTagQuery = executeQuery(_db, QStringLiteral("SELECT id, tag_id, name FROM tags WHERE evidence_id=?"),
-                                  {evidenceID});
-  while (getTagQuery.next()) {
-    auto tag = model::Tag(getTagQuery.value(QStringLiteral("id")).toLongLong(),
-                          getTagQuery.value(QStringLiteral("tag_id")).toLongLong(),
-                          getTagQuery.value(QStringLiteral("name")).toString());
-    tags.append(tag);
-  }
+  auto qStr = QStringLiteral("SELECT %1 FROM tags WHERE evidence_id=?").arg(TagMapper::columnList());
+  executeCachedQuery(qStr, {evidenceID}, [&tags](const QSqlQuery& getTagQuery) {
+    tags.append(TagMapper::read(getTagQuery));
+  });
   return tags;
 }
 
@@ -132,16 +426,14 @@ QList<model::Tag> DatabaseConnection::getFullTagsForEvidenceIDs(
     const QList<qint64>& evidenceIDs) {
   QList<model::Tag> tags;
 
-  batchQuery(QStringLiteral("SELECT id, evidence_id, tag_id, name FROM tags WHERE evidence_id IN (%1)"), 1, evidenceIDs.size(),
+  auto baseQuery = QStringLiteral("SELECT %1 FROM tags WHERE evidence_id IN (%2)")
+                       .arg(TagMapper::columnList(), QStringLiteral("%1"));
+  batchQuery(baseQuery, 1, evidenceIDs.size(),
       [evidenceIDs](unsigned int index){
         return QVariantList{evidenceIDs[index]};
       },
       [&tags](const QSqlQuery& resultItem){
-        auto tag = model::Tag(resultItem.value(QStringLiteral("id")).toLongLong(),
-                              resultItem.value(QStringLiteral("evidence_id")).toLongLong(),
-                              resultItem.value(QStringLiteral("tag_id")).toLongLong(),
-                              resultItem.value(QStringLiteral("name")).toString());
-        tags.append(tag);
+        tags.append(TagMapper::read(resultItem));
       });
 
   return tags;
@@ -156,20 +448,21 @@ bool DatabaseConnection::setEvidenceTags(const QList<model::Tag> &newTags, qint6
   for (const auto &tag : newTags)
     newTagIds.append(tag.serverTagId);
 
+  // the delete + insert below should not be seen (or survive) half-done
+  DBTransaction transaction(this);
+
   auto qDelStr = QStringLiteral("DELETE FROM tags WHERE tag_id NOT IN (?) AND evidence_id = ?");
-  auto a = executeQuery(_db, qDelStr, {newTagIds, evidenceID});
-  if(a.lastError().isValid())
+  if (!executeCachedQuery(qDelStr, {newTagIds, evidenceID}))
       return false;
 
+  QList<qint64> currentTags;
   auto qSelStr = QStringLiteral("SELECT tag_id FROM tags WHERE evidence_id = ?");
-  auto currentTagsResult = executeQuery(_db, qSelStr, {evidenceID});
-  if (currentTagsResult.lastError().isValid())
+  auto readCurrentTags = [&currentTags](const QSqlQuery& currentTagsResult) {
+    currentTags.append(currentTagsResult.value(0).toLongLong());
+  };
+  if (!executeCachedQuery(qSelStr, {evidenceID}, readCurrentTags))
       return false;
 
-  QList<qint64> currentTags;
-  while (currentTagsResult.next())
-    currentTags.append(currentTagsResult.value(QStringLiteral("tag_id")).toLongLong());
-
   struct dataset {
     qint64 evidenceID = 0;
     qint64 tagID = 0;
@@ -199,37 +492,62 @@ bool DatabaseConnection::setEvidenceTags(const QList<model::Tag> &newTags, qint6
       args.append(item.tagID);
       args.append(item.name);
     }
-    auto q = executeQuery(_db, baseQuery, args);
-    if (q.lastError().isValid())
+    if (!transaction.exec(baseQuery, args))
         return false;
   }
-  return true;
+  return transaction.commit();
 }
 
-void DatabaseConnection::batchCopyTags(const QList<model::Tag> &allTags) {
-  QString baseQuery = QStringLiteral("INSERT INTO tags (id, evidence_id, tag_id, name) VALUES %1");
-  int varsPerRow = 4;
-  std::function<QVariantList(int)> getItemValues = [allTags](int i){
-    model::Tag item = allTags.at(i);
-    return QVariantList{item.id, item.evidenceId, item.serverTagId, item.tagName};
-  };
-  batchInsert(baseQuery, varsPerRow, allTags.size(), getItemValues);
+bool DatabaseConnection::batchCopyTags(const QList<model::Tag> &allTags) {
+  auto rowQuery = QStringLiteral("INSERT INTO tags (id, evidence_id, tag_id, name) VALUES (?, ?, ?, ?)");
+  QList<QVariantList> columns(4);
+  for (auto &column : columns)
+    column.reserve(allTags.size());
+  for (const auto &item : allTags) {
+    columns[0].append(item.id);
+    columns[1].append(item.evidenceId);
+    columns[2].append(item.serverTagId);
+    columns[3].append(item.tagName);
+  }
+  return batchInsertColumns(rowQuery, columns);
 }
 
-DBQuery DatabaseConnection::buildGetEvidenceWithFiltersQuery(const EvidenceFilters &filters)
+DBQuery DatabaseConnection::buildGetEvidenceWithFiltersQuery(const EvidenceFilters &filters,
+                                                             bool includeTags)
 {
-  QString query = _sqlSelectTemplate.arg(_evidenceAllKeys, _tblEvidence);
+  return buildEvidenceQuery(filters, includeTags);
+}
+
+DBQuery DatabaseConnection::buildEvidenceQuery(const EvidenceFilters &filters, bool includeTags,
+                                               const QStringList &extraParts,
+                                               const QVariantList &extraValues,
+                                               const QString &suffix)
+{
+  QString query = _sqlSelectTemplate.arg(includeTags ? _evidenceWithTagsKeys : _evidenceAllKeys,
+                                         _tblEvidence);
   QVariantList values;
   QStringList parts;
 
+  // The search is joined as a subquery, which only exposes the id and rank. Otherwise, the
+  // (identically named) search columns would make the evidence columns ambiguous.
+  QString searchExpression = toSearchExpression(filters.text);
+  if (!searchExpression.isEmpty()) {
+    query.append(QStringLiteral(" JOIN (SELECT rowid AS search_id, rank AS search_rank"
+                                " FROM evidence_search WHERE evidence_search MATCH ?) AS search"
+                                " ON search.search_id = evidence.id"));
+    values.append(searchExpression);
+  }
+
   if (filters.hasError != Tri::Any) {
-    parts.append(QStringLiteral(" error LIKE ? "));
-    // _% will ensure at least one character exists in the error column, ensuring it's populated
-    values.append(filters.hasError == Tri::Yes ? QStringLiteral("_%") : QString());
+    // plain comparisons (rather than LIKE) let sqlite use idx_evidence_has_error
+    if (filters.hasError == Tri::Yes)
+      parts.append(QStringLiteral(" error != '' "));
+    else
+      parts.append(QStringLiteral(" error = '' "));
   }
 
   if (filters.submitted != Tri::Any) {
-    auto sub = QStringLiteral(" upload_data IS%1NULL");
+    auto sub = QStringLiteral(" upload_date IS%1NULL");
     if(filters.submitted == Tri::Yes)
         parts.append(sub.arg(QStringLiteral(" NOT ")));
     else
@@ -254,17 +572,60 @@ DBQuery DatabaseConnection::buildGetEvidenceWithFiltersQuery(const EvidenceFilte
     values.append(realEndDate);
   }
 
+  // tag names are matched case-insensitively, as the tag editor treats them
+  auto tagSubquery = QStringLiteral(" evidence.id %1 (SELECT evidence_id FROM tags WHERE name COLLATE NOCASE IN (%2)) ");
+  auto placeholders = [](qsizetype count) {
+    auto rtn = QStringLiteral("?, ").repeated(count);
+    rtn.chop(2);
+    return rtn;
+  };
+  for (const auto &tagGroup : filters.tags) {
+    parts.append(tagSubquery.arg(QStringLiteral("IN"), placeholders(tagGroup.size())));
+    for (const auto &name : tagGroup)
+      values.append(name);
+  }
+  if (!filters.excludedTags.isEmpty()) {
+    parts.append(tagSubquery.arg(QStringLiteral("NOT IN"), placeholders(filters.excludedTags.size())));
+    for (const auto &name : filters.excludedTags)
+      values.append(name);
+  }
+
+  parts.append(extraParts);
+  values.append(extraValues);
+
   if (!parts.empty()) {
     query.append(QStringLiteral(" WHERE %1").arg(parts.at(0)));
     for (size_t i = 1; i < parts.size(); i++)
       query.append(QStringLiteral(" AND %1").arg(parts.at(i)));
   }
+  if (suffix.isEmpty() && !searchExpression.isEmpty())
+    query.append(QStringLiteral(" ORDER BY search.search_rank"));
+  query.append(suffix);
   return DBQuery(query, values);
 }
 
-void DatabaseConnection::updateEvidencePath(const QString& newPath, qint64 evidenceID)
+QString DatabaseConnection::toJsonIDList(const QList<qint64> &ids)
 {
-    executeQuery(_db, QStringLiteral("UPDATE evidence SET path=? WHERE id=?"), {newPath, evidenceID});
+    QJsonArray array;
+    for (auto id : ids)
+        array.append(id);
+    return QString::fromUtf8(QJsonDocument(array).toJson(QJsonDocument::Compact));
+}
+
+QString DatabaseConnection::toSearchExpression(const QString &text)
+{
+  const auto words = text.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+  QStringList terms;
+  for (auto word : words) {
+    word.replace(QStringLiteral("\""), QStringLiteral("\"\""));
+    terms.append(QStringLiteral("\"%1\"*").arg(word));
+  }
+  return terms.join(QLatin1Char(' '));
+}
+
+bool DatabaseConnection::updateEvidencePath(const QString& newPath, qint64 evidenceID)
+{
+    return executeCachedQuery(QStringLiteral("UPDATE evidence SET path=? WHERE id=?"), {newPath, evidenceID});
 }
 
 QList<model::Evidence> DatabaseConnection::getEvidenceWithFilters(const EvidenceFilters &filters)
@@ -273,46 +634,93 @@ QList<model::Evidence> DatabaseConnection::getEvidenceWithFilters(const Evidence
     auto resultSet = executeQuery(_db, dbQuery.query(), dbQuery.values());
     QList<model::Evidence> allEvidence;
 
-    while (resultSet.next()) {
-        model::Evidence evi;
-        evi.id = resultSet.value(QStringLiteral("id")).toLongLong();
-        evi.path = resultSet.value(QStringLiteral("path")).toString();
-        evi.operationSlug = resultSet.value(QStringLiteral("operation_slug")).toString();
-        evi.contentType = resultSet.value(QStringLiteral("content_type")).toString();
-        evi.description = resultSet.value(QStringLiteral("description")).toString();
-        evi.errorText = resultSet.value(QStringLiteral("error")).toString();
-        evi.recordedDate = resultSet.value(QStringLiteral("recorded_date")).toDateTime();
-        evi.uploadDate = resultSet.value(QStringLiteral("upload_date")).toDateTime();
-        evi.recordedDate.setTimeZone(QTimeZone::UTC);
-        evi.uploadDate.setTimeZone(QTimeZone::UTC);
-        allEvidence.append(evi);
-    }
+    while (resultSet.next())
+        allEvidence.append(decodeEvidence(resultSet, false));
 
     return allEvidence;
 }
 
-QList<model::Evidence> DatabaseConnection::createEvidenceExportView(
-    const QString& pathToExport, const EvidenceFilters& filters, DatabaseConnection *runningDB)
+QList<model::Evidence> DatabaseConnection::getFullEvidenceWithFilters(const EvidenceFilters &filters)
 {
-    QList<model::Evidence> exportEvidence;
-    auto exportViewAction = [runningDB, filters, &exportEvidence](DatabaseConnection exportDB) {
-        exportEvidence = runningDB->getEvidenceWithFilters(filters);
-        exportDB.batchCopyFullEvidence(exportEvidence);
-        QList<qint64> evidenceIds;
-        evidenceIds.resize(exportEvidence.size());
-        std::transform(exportEvidence.begin(), exportEvidence.end(), evidenceIds.begin(),
-                       [](const model::Evidence& e) { return e.id; });
-        QList<model::Tag> tags = runningDB->getFullTagsForEvidenceIDs(evidenceIds);
-        exportDB.batchCopyTags(tags);
+    auto dbQuery = buildGetEvidenceWithFiltersQuery(filters, true);
+    auto resultSet = executeQuery(_db, dbQuery.query(), dbQuery.values());
+    QList<model::Evidence> allEvidence;
+
+    while (resultSet.next())
+        allEvidence.append(decodeEvidence(resultSet, true));
+
+    return allEvidence;
+}
+
+bool DatabaseConnection::createEvidenceExportView(
+    const QString& pathToExport, const EvidenceFilters& filters, DatabaseConnection *runningDB,
+    const std::function<void(const QList<model::Evidence>&)> &onPage)
+{
+    bool exported = false;
+    auto exportViewAction = [runningDB, filters, &onPage, &exported](DatabaseConnection& exportDB) {
+        DBTransaction transaction(&exportDB);
+        EvidenceCursor cursor(filters, true);
+        while (!cursor.atEnd()) {
+            auto page = cursor.nextPage(runningDB);
+            if (!cursor.errorString().isEmpty())
+                return;
+            // the cursor leaves out the content text, which the export needs to be searchable
+            QList<qint64> pageIDs;
+            pageIDs.reserve(page.size());
+            for (const auto &evi : std::as_const(page))
+                pageIDs.append(evi.id);
+            const auto contentText = runningDB->getEvidenceContentText(pageIDs);
+            for (auto &evi : page)
+                evi.contentText = contentText.value(evi.id);
+            if (!exportDB.batchCopyFullEvidence(page))
+                return;
+            QList<model::Tag> tags;
+            for (const auto &evi : page)
+                tags.append(evi.tags);
+            if (!exportDB.batchCopyTags(tags))
+                return;
+            onPage(page);
+        }
+        exported = transaction.commit();
     };
-    withConnection(pathToExport, QStringLiteral("exportDB"), exportViewAction);
-    return exportEvidence;
+    exported = withConnection(pathToExport, QStringLiteral("exportDB"), exportViewAction) && exported;
+    if (!exported)
+        qWarning() << "Unable to create evidence export view at" << pathToExport;
+    return exported;
+}
+
+qint64 DatabaseConnection::countEvidenceWithFilters(const EvidenceFilters &filters)
+{
+    auto dbQuery = buildGetEvidenceWithFiltersQuery(filters);
+    auto result = executeQueryNoThrow(
+        _db, QStringLiteral("SELECT COUNT(*) FROM (%1)").arg(dbQuery.query()), dbQuery.values());
+    if (!result.success || !result.query.next())
+        return -1;
+    return result.query.value(0).toLongLong();
 }
 
 bool DatabaseConnection::migrateDB()
 {
     qInfo() << "Checking database state";
+    QElapsedTimer timer;
+    timer.start();
+    const int expectedVersion = MigrationInfo::schemaVersion;
+
+    // fast path: an up to date database has already recorded the final schema version
+    if (schemaVersion() == expectedVersion) {
+        qInfo() << "Database schema is current (version" << expectedVersion << "), checked in"
+                << timer.elapsed() << "ms";
+        return true;
+    }
+
+    // The pending list is (re)computed inside the transaction, as another connection may have
+    // migrated the database while this one waited for the write lock.
+    DBTransaction transaction(this);
+    if (!transaction.isActive())
+        return false;
     auto migrationsToApply = DatabaseConnection::getUnappliedMigrations();
+    const auto checkedMs = timer.elapsed();
+    Q_ASSERT(availableMigrations().size() == expectedVersion);
 
     for (const auto &newMigration : migrationsToApply) {
         QFile migrationFile(QStringLiteral("%1/%2").arg(_migrationPath, newMigration));
@@ -322,18 +730,44 @@ bool DatabaseConnection::migrateDB()
         migrationFile.close();
         qInfo() << "Applying Migration: " << newMigration;
         auto upScript = extractMigrateUpContent(content);
-        executeQuery(_db, upScript);
-        executeQuery(_db, _sqlAddAppliedMigration, {newMigration});
+        if (!transaction.exec(upScript) || !transaction.exec(_sqlAddAppliedMigration, {newMigration})) {
+            qWarning() << "Unable to apply migration" << newMigration << ":" << _db.lastError().text();
+            return false;
+        }
+    }
+    // user_version is part of the database header, so it is updated atomically with the migrations
+    transaction.exec(QStringLiteral("PRAGMA user_version = %1").arg(expectedVersion));
+    if (!transaction.commit()) {
+        qWarning() << "Unable to commit migrations: " << _db.lastError().text();
+        return false;
     }
 
-    qInfo() << "All migrations applied";
+    qInfo() << "All migrations applied." << migrationsToApply.size() << "applied in"
+            << timer.elapsed() - checkedMs << "ms, after a" << checkedMs << "ms check";
     return true;
 }
 
+int DatabaseConnection::schemaVersion()
+{
+    auto result = executeQueryNoThrow(_db, QStringLiteral("PRAGMA user_version"));
+    if (!result.success || !result.query.next())
+        return 0;
+    return result.query.value(0).toInt();
+}
+
+const QStringList &DatabaseConnection::availableMigrations()
+{
+    // the migrations are compiled in, so they only need to be listed once per run
+    static const QStringList migrations = [] {
+        QDir migrationsDir(_migrationPath);
+        return migrationsDir.entryList({QStringLiteral("*.sql")}, QDir::Files, QDir::Name);
+    }();
+    return migrations;
+}
+
 QStringList DatabaseConnection::getUnappliedMigrations()
 {
-    QDir migrationsDir(_migrationPath);
-    const auto allMigrations = migrationsDir.entryList(QDir::Files, QDir::Name);
+    const auto &allMigrations = availableMigrations();
     QStringList appliedMigrations;
     QStringList migrationsToApply;
 
@@ -343,8 +777,6 @@ QStringList DatabaseConnection::getUnappliedMigrations()
         appliedMigrations << dbMigrations->value(_migration_name).toString();
     // compare the two list to find gaps
     for (const auto &possibleMigration : allMigrations) {
-        if (!possibleMigration.endsWith(QStringLiteral(".sql")))
-            continue;
         auto foundIndex = appliedMigrations.indexOf(possibleMigration);
         if (foundIndex == -1)
             migrationsToApply << possibleMigration;
@@ -388,6 +820,7 @@ QueryResult DatabaseConnection::executeQueryNoThrow(const QSqlDatabase& db, cons
                                                   const QVariantList &args) noexcept
 {
     QSqlQuery query(db);
+    query.setForwardOnly(true);
     if (!query.prepare(stmt))
         return QueryResult(std::move(query));
     for (const auto &arg : args)
@@ -396,6 +829,89 @@ QueryResult DatabaseConnection::executeQueryNoThrow(const QSqlDatabase& db, cons
     return QueryResult(std::move(query));
 }
 
+QSqlQuery* DatabaseConnection::cachedStatement(const QString &stmt)
+{
+    auto found = _statementCache.find(stmt);
+    if (found != _statementCache.end()) {
+        _statementCacheHits++;
+        return &found->second;
+    }
+
+    QSqlQuery query(_db);
+    query.setForwardOnly(true);
+    if (!query.prepare(stmt)) {
+        qWarning() << "Error preparing Query: " << query.lastError().text();
+        return nullptr;
+    }
+    _statementCacheMisses++;
+    return &_statementCache.emplace(stmt, std::move(query)).first->second;
+}
+
+// executeCachedQuery binds args positionally (rather than with addBindValue) so that values left
+// over from a previous run of the same statement are always overwritten.
+bool DatabaseConnection::executeCachedQuery(const QString &stmt, const QVariantList &args,
+                                            const RowDecoderFunc &decodeRows)
+{
+    auto query = cachedStatement(stmt);
+    if (query == nullptr)
+        return false;
+    for (int i = 0; i < args.size(); i++)
+        query->bindValue(i, args.at(i));
+
+    bool success = query->exec();
+    if (!success)
+        qWarning() << "Error executing Query: " << query->lastError().text();
+    while (success && decodeRows && query->next())
+        decodeRows(*query);
+    // release the result set (and any read lock) while keeping the statement prepared
+    query->finish();
+    return success;
+}
+
+qint64 DatabaseConnection::doCachedInsert(const QString &stmt, const QVariantList &args)
+{
+    auto query = cachedStatement(stmt);
+    if (query == nullptr)
+        return -1;
+    for (int i = 0; i < args.size(); i++)
+        query->bindValue(i, args.at(i));
+
+    qint64 rtn = -1;
+    if (!query->exec())
+        qWarning() << "Error executing Query: " << query->lastError().text();
+    else if (query->lastInsertId().isValid())
+        rtn = query->lastInsertId().toLongLong();
+    query->finish();
+    return rtn;
+}
+
+// batchInsertColumns binds each column's values once, and lets execBatch step the single-row
+// statement through them. Everything happens in one transaction, so there is only a single sync.
+bool DatabaseConnection::batchInsertColumns(const QString &rowInsertQuery,
+                                            const QList<QVariantList> &columns)
+{
+    if (columns.isEmpty() || columns.first().isEmpty())
+        return true;
+
+    DBTransaction transaction(this);
+    auto query = cachedStatement(rowInsertQuery);
+    if (query == nullptr)
+        return false;
+    for (int i = 0; i < columns.size(); i++)
+        query->bindValue(i, columns.at(i));
+
+    bool success = query->execBatch();
+    if (!success)
+        qWarning() << "Error executing batch insert: " << query->lastError().text();
+    query->finish();
+    // the bound columns can be large; don't keep them alive in the statement cache
+    for (int i = 0; i < columns.size(); i++)
+        query->bindValue(i, QVariant());
+    if (!success)
+        return false;
+    return transaction.commit();
+}
+
 // doInsert is a version of executeQuery that returns the last inserted id, rather than the
 // underlying query/response
 // Logs then returns -1
@@ -407,16 +923,16 @@ qint64 DatabaseConnection::doInsert(const QSqlDatabase& db, const QString &stmt,
   return -1;
 }
 
-void DatabaseConnection::batchInsert(const QString& baseQuery, unsigned int varsPerRow, unsigned int numRows,
+bool DatabaseConnection::batchInsert(const QString& baseQuery, unsigned int varsPerRow, unsigned int numRows,
                                      const FieldEncoderFunc& encodeValues, QString rowInsertTemplate) {
   if (rowInsertTemplate.isEmpty()) {
     rowInsertTemplate = "(" + QString("?,").repeated(varsPerRow > 0 ? varsPerRow-1 : 0) + "?),";
   }
   auto noop = [](const QSqlQuery&){};
-  batchQuery(baseQuery, varsPerRow, numRows, encodeValues, noop, rowInsertTemplate);
+  return batchQuery(baseQuery, varsPerRow, numRows, encodeValues, noop, rowInsertTemplate);
 }
 
-void DatabaseConnection::batchQuery(const QString &baseQuery, unsigned int varsPerRow,
+bool DatabaseConnection::batchQuery(const QString &baseQuery, unsigned int varsPerRow,
                                     unsigned int numRows, const FieldEncoderFunc &encodeValues,
                                     const RowDecoderFunc& decodeRows, QString variableTemplate) {
   unsigned long frameSize = SQLITE_MAX_VARS / varsPerRow;
@@ -444,24 +960,31 @@ void DatabaseConnection::batchQuery(const QString &baseQuery, unsigned int varsP
     return values;
   };
   /// runQuery executes the given query, and iterates over the result set
-  auto runQuery = [this, decodeRows](const QString &query, const QVariantList& values) {
-    auto completedQuery = executeQuery(_db, query, values);
-    while (completedQuery.next()) {
-      decodeRows(completedQuery);
+  bool success = true;
+  auto runQuery = [this, decodeRows, &success](const QString &query, const QVariantList& values) {
+    auto result = executeQueryNoThrow(_db, query, values);
+    if (!result.success) {
+      qWarning() << "Error executing Query: " << result.err.text();
+      success = false;
+      return;
+    }
+    while (result.query.next()) {
+      decodeRows(result.query);
     }
   };
 
   // do full frames
   QString fullFrameQuery = baseQuery.arg(prepArgString(frameSize));
-  for(unsigned long frameIndex = 0; frameIndex < numFullFrames; frameIndex++) {
+  for(unsigned long frameIndex = 0; success && frameIndex < numFullFrames; frameIndex++) {
     QVariantList values = encodeRowValues(frameSize);
     runQuery(fullFrameQuery, values); // an alternative here: use execBatch, which might slightly hasten results
   }
 
   // do the remainder
-  if (overflow > 0) {
+  if (success && overflow > 0) {
     QString overflowQuery = baseQuery.arg(prepArgString(overflow));
     QVariantList overflowValues = encodeRowValues(overflow);
     runQuery(overflowQuery, overflowValues);
   }
+  return success;
 }
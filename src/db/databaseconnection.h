@@ -1,5 +1,10 @@
 #pragma once
 
+#include <map>
+
+#include <QHash>
+#include <QSet>
+
 #include <QSqlDatabase>
 #include <QSqlDriver>
 #include <QSqlError>
@@ -8,8 +13,34 @@
 
 #include "forms/evidence_filter/evidencefilter.h"
 #include "models/evidence.h"
+#include "models/evidencestats.h"
+#include "models/upload.h"
 #include "helpers/constants.h"
 #include "query_result.h"
+#include "row_mapper.h"
+
+/// EvidenceMapper decodes the columns of the evidence table, in this order (see db::RowMapper).
+/// content_text is left out, as it can hold a whole codeblock: most reads never need it, so it is
+/// only read on request (see DatabaseConnection::getEvidenceContentText).
+using EvidenceMapper = db::RowMapper<model::Evidence
+    , db::Column<"id", &model::Evidence::id>
+    , db::Column<"path", &model::Evidence::path>
+    , db::Column<"operation_slug", &model::Evidence::operationSlug>
+    , db::Column<"content_type", &model::Evidence::contentType>
+    , db::Column<"description", &model::Evidence::description>
+    , db::Column<"error", &model::Evidence::errorText>
+    , db::Column<"recorded_date", &model::Evidence::recordedDate>
+    , db::Column<"upload_date", &model::Evidence::uploadDate>
+    , db::Column<"content_hash", &model::Evidence::contentHash>
+>;
+
+/// TagMapper decodes the columns of the tags table, in this order (see db::RowMapper)
+using TagMapper = db::RowMapper<model::Tag
+    , db::Column<"id", &model::Tag::id>
+    , db::Column<"evidence_id", &model::Tag::evidenceId>
+    , db::Column<"tag_id", &model::Tag::serverTagId>
+    , db::Column<"name", &model::Tag::tagName>
+>;
 
 using FieldEncoderFunc = std::function<QVariantList(unsigned int)>;
 using RowDecoderFunc = std::function<void(const QSqlQuery&)>;
@@ -41,6 +72,9 @@ class DatabaseConnection {
    * @param databaseName - Name of the databaseFile or defaultName if none provided
    */
   DatabaseConnection(const QString& dbPath, const QString& databaseName = Constants::defaultDbName);
+  /// Connections own their prepared statements, so they cannot be copied. Share a pointer instead.
+  DatabaseConnection(const DatabaseConnection&) = delete;
+  DatabaseConnection& operator=(const DatabaseConnection&) = delete;
 
   /**
    * @brief withConnection acts as a context manager for a single database connection. The goal for
@@ -54,23 +88,70 @@ class DatabaseConnection {
    * Returns True is successful
    */
   static bool withConnection(const QString& dbPath, const QString &dbName,
-                             const std::function<void(DatabaseConnection)> &actions);
+                             const std::function<void(DatabaseConnection&)> &actions);
 
   ///Return the last Error
   [[nodiscard]] QString errorString() const {return _db.lastError().text();}
   [[nodiscard]] bool connect();
-  void close() noexcept {_db.close();}
+  void close() noexcept;
+
+  /**
+   * @brief useWriteAheadLog switches the (open) database into WAL journal mode, allowing readers on
+   * other connections to continue while one connection writes. The journal mode is stored in the
+   * database file, so this should only be used on the primary database, not on import/export files.
+   * @return true if successful
+   */
+  bool useWriteAheadLog();
 
-  static DBQuery buildGetEvidenceWithFiltersQuery(const EvidenceFilters &filters);
+  /// statementCacheHits returns how many statements were served from the prepared statement cache
+  [[nodiscard]] quint64 statementCacheHits() const { return _statementCacheHits; }
+  /// statementCacheMisses returns how many statements had to be prepared (and were then cached)
+  [[nodiscard]] quint64 statementCacheMisses() const { return _statementCacheMisses; }
 
+  /**
+   * @brief buildGetEvidenceWithFiltersQuery builds the query used to find evidence matching filters
+   * @param filters The filters to apply
+   * @param includeTags if true, each row also carries its tags (see decodeEvidence)
+   */
+  static DBQuery buildGetEvidenceWithFiltersQuery(const EvidenceFilters &filters,
+                                                  bool includeTags = false);
+
+  /**
+   * @brief buildEvidenceQuery is the general form of buildGetEvidenceWithFiltersQuery.
+   * @param filters The filters to apply
+   * @param includeTags if true, each row also carries its tags (see decodeEvidence)
+   * @param extraParts Additional conditions, ANDed with the filter conditions
+   * @param extraValues Values for any "?" in extraParts, in order
+   * @param suffix Appended after the WHERE clause (e.g. ORDER BY / LIMIT). Must not contain "?".
+   * If empty, and the filters include text, results are ordered by search rank.
+   */
+  static DBQuery buildEvidenceQuery(const EvidenceFilters &filters, bool includeTags,
+                                    const QStringList &extraParts = {},
+                                    const QVariantList &extraValues = {},
+                                    const QString &suffix = QString());
+
+  /// getEvidenceDetails retrieves a single evidence, along with its tags. id is -1 if not found
   model::Evidence getEvidenceDetails(qint64 evidenceID);
+  /**
+   * @brief getEvidenceDetails retrieves many evidence (with tags) in as few queries as possible
+   * @param evidenceIDs the evidence to retrieve. Ids that do not exist are skipped.
+   * @return The found evidence, in no particular order
+   */
+  QList<model::Evidence> getEvidenceDetails(const QList<qint64> &evidenceIDs);
+  /// getEvidenceWithFilters retrieves all evidence matching filters. Tags are not populated.
+  /// For large result sets, prefer an EvidenceCursor, which reads the results in pages.
   QList<model::Evidence> getEvidenceWithFilters(const EvidenceFilters &filters);
+  /// getFullEvidenceWithFilters is a version of getEvidenceWithFilters that also populates tags
+  QList<model::Evidence> getFullEvidenceWithFilters(const EvidenceFilters &filters);
 
   /// Return -1 if Failed
   qint64 createEvidence(const QString &filepath, const QString &operationSlug,
-                        const QString &contentType);
+                        const QString &contentType, const QString &contentText = QString(),
+                        const QString &contentHash = QString());
   qint64 createFullEvidence(const model::Evidence &evidence);
-  void batchCopyFullEvidence(const QList<model::Evidence> &evidence);
+  /// batchCopyFullEvidence inserts all of evidence (ids and content text included) in a single
+  /// transaction. Returns true if successful
+  bool batchCopyFullEvidence(const QList<model::Evidence> &evidence);
   qint64 copyFullEvidence(const model::Evidence &evidence);
 
   /**
@@ -81,35 +162,170 @@ class DatabaseConnection {
   */
   bool updateEvidenceDescription(const QString &newDescription, qint64 evidenceID);
   bool updateEvidenceError(const QString &errorText, qint64 evidenceID);
+  /// updateEvidenceContentText sets the searchable text for the evidence (see model::Evidence::contentText)
+  /// Returns true if successful
+  bool updateEvidenceContentText(const QString &contentText, qint64 evidenceID);
+  /**
+   * @brief getEvidencePathsWithoutContentText finds evidence of the given content type that has
+   * not had its searchable text recorded (e.g. evidence captured before search was supported)
+   * @return A mapping of evidence id to evidence path
+   */
+  QHash<qint64, QString> getEvidencePathsWithoutContentText(const QString &contentType);
+  /**
+   * @brief getEvidenceContentText reads the searchable text of the given evidence, which the
+   * other evidence reads leave empty (see EvidenceMapper)
+   * @return A mapping of evidence id to content text. Ids that do not exist are skipped.
+   */
+  QHash<qint64, QString> getEvidenceContentText(const QList<qint64> &evidenceIDs);
+  /// updateEvidenceContentHash sets the content hash for the evidence (see model::Evidence::contentHash)
+  /// Returns true if successful
+  bool updateEvidenceContentHash(const QString &contentHash, qint64 evidenceID);
+  /**
+   * @brief getEvidencePathsWithoutContentHash finds evidence that has not had its content hash
+   * recorded (e.g. evidence captured before hashing was supported)
+   * @param afterEvidenceID Only evidence with a greater id is returned, so that a caller can page
+   * past evidence whose file cannot be hashed
+   * @param limit The maximum number of evidence to return
+   * @return A mapping of evidence id to evidence path
+   */
+  QHash<qint64, QString> getEvidencePathsWithoutContentHash(qint64 afterEvidenceID, int limit);
+  /**
+   * @brief findDuplicateEvidence finds other evidence, within the same operation, with identical content
+   * @return the id of the oldest such evidence, or 0 if there is none
+   */
+  qint64 findDuplicateEvidence(const QString &contentHash, const QString &operationSlug,
+                               qint64 excludingEvidenceID);
+  /// isEvidencePathInUse returns true if any evidence still refers to path. Content-addressed
+  /// evidence files are shared, so this must be checked before a file is removed.
+  bool isEvidencePathInUse(const QString &path, const QString &contentHash);
   void updateEvidenceSubmitted(qint64 evidenceID);
-  void updateEvidencePath(const QString& newPath, qint64 evidenceID);
+  bool updateEvidencePath(const QString& newPath, qint64 evidenceID);
   bool setEvidenceTags(const QList<model::Tag> &newTags, qint64 evidenceID);
-  void batchCopyTags(const QList<model::Tag> &allTags);
+  /// batchCopyTags inserts all of allTags (ids included) in a single transaction
+  /// Returns true if successful
+  bool batchCopyTags(const QList<model::Tag> &allTags);
   QList<model::Tag> getFullTagsForEvidenceIDs(const QList<qint64>& evidenceIDs);
 
+  /**
+   * @brief getEvidenceStats reads the evidence counts for an operation. The counts are maintained
+   * by triggers on the evidence table, so no evidence is read.
+   * @param operationSlug The operation to count
+   * @param contentType Limits the count to one content type. If empty, all types are counted.
+   */
+  model::EvidenceStats getEvidenceStats(const QString &operationSlug,
+                                        const QString &contentType = QString());
+
   /**
    * @brief deleteEvidence Delete Evidence from the database
    * @param evidenceID - ID To Delete
    * @return true if successful
    */
   bool deleteEvidence(qint64 evidenceID);
+  /**
+   * @brief deleteEvidence deletes many evidence, along with their tags, in a single transaction,
+   * using one statement per table
+   * @param evidenceIDs The evidence to delete. Ids that do not exist are skipped.
+   * @param deleted Receives the deleted evidence (only id, path and contentHash are populated)
+   * @return true if successful. On failure, nothing is deleted.
+   */
+  bool deleteEvidence(const QList<qint64> &evidenceIDs, QList<model::Evidence> &deleted);
+  /**
+   * @brief getEvidencePathsInUse checks which of the given evidence files are still referred to by
+   * other evidence (i.e. shared, content-addressed files), and so must not be removed
+   * @param evidence Evidence with path and contentHash populated
+   * @return the subset of paths still in use
+   */
+  QSet<QString> getEvidencePathsInUse(const QList<model::Evidence> &evidence);
+
+  /**
+   * @brief enqueueUploads adds evidence to the upload queue. Evidence that is already queued (or
+   * previously failed) is queued again, with its attempts reset.
+   * @param evidenceIDs The evidence to upload. Submitted evidence, evidence that is being uploaded,
+   * and ids that do not exist, are skipped.
+   * @param now The current time, in ms since the epoch
+   * @param queuedIDs Set to the evidence that was actually queued
+   * @return true if successful
+   */
+  bool enqueueUploads(const QList<qint64> &evidenceIDs, qint64 now, QList<qint64> &queuedIDs);
+  /// resetInterruptedUploads requeues uploads left in progress (e.g. by a previous run that exited
+  /// mid-upload). Returns true if successful
+  bool resetInterruptedUploads();
+  /**
+   * @brief claimUploads marks the oldest queued uploads that are due as in progress, counting an
+   * attempt for each
+   * @param limit The maximum number of uploads to claim
+   * @param now The current time, in ms since the epoch
+   * @return The claimed uploads (evidence includes tags). On failure, nothing is claimed.
+   */
+  QList<model::QueuedUpload> claimUploads(int limit, qint64 now);
+  /// nextUploadAttemptAt returns when the next queued upload is due (in ms since the epoch), or -1
+  /// if nothing is queued
+  qint64 nextUploadAttemptAt();
+  /// completeUpload marks the evidence as submitted, and its queued upload as done. Returns true if successful
+  bool completeUpload(qint64 evidenceID);
+  /// retryUpload returns an upload to the queue after a failed attempt, to be retried at
+  /// nextAttemptAt (ms since the epoch). Returns true if successful
+  bool retryUpload(qint64 evidenceID, const QString &errorText, qint64 nextAttemptAt);
+  /// failUpload gives up on a queued upload, recording errorText on the evidence. Returns true if successful
+  bool failUpload(qint64 evidenceID, const QString &errorText);
 
-  /// createEvidenceExportView duplicates the normal database with only a subset of evidence
-  /// present, as well as related data (e.g. tags)
-  ///
-  /// Note that currently, this simply exports everything. This is included as a way to limit
-  /// sharing in the future.
-  static QList<model::Evidence> createEvidenceExportView(const QString& pathToExport,
-                                                               const EvidenceFilters& filters,
-                                                               DatabaseConnection *runningDB);
+  /**
+   * @brief createEvidenceExportView duplicates the normal database with only a subset of evidence
+   * present, as well as related data (e.g. tags). The evidence is read and written one page at a
+   * time (see EvidenceCursor), so the export set is never held in memory as a whole.
+   *
+   * Note that currently, this simply exports everything. This is included as a way to limit
+   * sharing in the future.
+   * @param onPage Called with each page of evidence (with tags) once it is in the export database,
+   * e.g. to copy the evidence files
+   * @return true if successful. If the export fails, the export database is rolled back, though
+   * the pages already passed to onPage have been handled.
+   */
+  static bool createEvidenceExportView(
+      const QString& pathToExport, const EvidenceFilters& filters, DatabaseConnection *runningDB,
+      const std::function<void(const QList<model::Evidence>&)> &onPage);
+  /// countEvidenceWithFilters returns the number of evidence matching filters, or -1 on error
+  qint64 countEvidenceWithFilters(const EvidenceFilters &filters);
   QList<model::Tag> getTagsForEvidenceID(qint64 evidenceID);
 
   [[nodiscard]] QSqlError lastError() const {return _db.lastError();}
 
+  /**
+   * @brief batchInsert batches multiple inserts over as few requests as possible.
+   * @param baseQuery The insert string, up to " VALUES "
+   * @param varsPerRow the number of items per row
+   * @param numRows the number of rows you wish to insert
+   * @param encodeValues A function that, given a row index, will return a QVariantList with each column's data for that row
+   * @param rowInsertTemplate An optional string that can be used to define each row's values. Defaults to (?, ..., ?)
+   * @return true if every frame was inserted. Callers wanting all-or-nothing should use a DBTransaction
+   */
+  bool batchInsert(const QString& baseQuery, unsigned int varsPerRow, unsigned int numRows,
+                   const FieldEncoderFunc& encodeValues, QString rowInsertTemplate = QString());
+
+  /**
+   * @brief batchInsertColumns inserts many rows with a single prepared (single row) statement,
+   * using execBatch, inside of one transaction. Unlike batchInsert, this is not limited by
+   * SQLITE_MAX_VARS, and the statement is only parsed once.
+   * @param rowInsertQuery An insert statement for a single row, e.g. INSERT INTO t (a, b) VALUES (?, ?)
+   * @param columns One list of values per "?", each with one entry per row
+   * @return true if all rows were inserted; on failure, no rows are inserted
+   */
+  bool batchInsertColumns(const QString &rowInsertQuery, const QList<QVariantList> &columns);
+
  private:
+  friend class DBTransaction;
+  friend class EvidenceCursor;
   QString _dbName;
   QString _dbPath;
   QSqlDatabase _db = QSqlDatabase();
+  /// _statementCache holds prepared statements for fixed queries, keyed by their sql text
+  std::map<QString, QSqlQuery> _statementCache;
+  quint64 _statementCacheHits = 0;
+  quint64 _statementCacheMisses = 0;
+  /// _transactionDepth counts the open DBTransactions on this connection (nested ones are savepoints)
+  int _transactionDepth = 0;
+  /// _busyTimeoutMs is how long a connection waits on another connection's write lock before failing
+  inline static const int _busyTimeoutMs = 10000;
   inline static const auto _migrateUp = QStringLiteral("-- +migrate up");
   inline static const auto _migrateDown = QStringLiteral("-- +migrate down");
   inline static const auto _newLine = QStringLiteral("\n");
@@ -121,13 +337,38 @@ class DatabaseConnection {
   inline static const auto _migration_name = QStringLiteral("migration_name");
   inline static const auto _tblEvidence = QStringLiteral("evidence");
   inline static const auto _tblMigrations = QStringLiteral("migrations");
-  inline static const auto _evidenceAllKeys = QStringLiteral("id, path, operation_slug, content_type, description, error, recorded_date, upload_date");
+  inline static const auto _evidenceAllKeys = EvidenceMapper::columnList();
+  /// _evidenceCopyKeys is _evidenceAllKeys, plus content_text, for copying evidence in full
+  inline static const auto _evidenceCopyKeys = QStringLiteral("%1, content_text").arg(_evidenceAllKeys);
+  /// _evidenceWithTagsKeys is _evidenceAllKeys, plus each row's tags, encoded as a json array of [id, tag_id, name]
+  inline static const auto _evidenceWithTagsKeys = QStringLiteral("%1, (SELECT json_group_array(json_array(tags.id, tags.tag_id, tags.name)) FROM tags WHERE tags.evidence_id = evidence.id) AS tags").arg(_evidenceAllKeys);
+
+  /// decodeEvidence reads an evidence row selected with _evidenceAllKeys or (if includesTags)
+  /// _evidenceWithTagsKeys. Tags are only populated for the latter.
+  static model::Evidence decodeEvidence(const QSqlQuery &query, bool includesTags);
+
+  /// toSearchExpression converts free text into an FTS5 query, matching every word (as a prefix).
+  /// Words are quoted, so FTS5 syntax in the text is searched for, rather than interpreted.
+  static QString toSearchExpression(const QString &text);
+
+  /// toJsonIDList encodes ids as a json array, so that a whole list can be bound to a single "?"
+  /// and read back with json_each. Statements using it are then prepared once, whatever the count.
+  static QString toJsonIDList(const QList<qint64> &ids);
 
   /**
-   * @brief migrateDB - Check migration status and apply any outstanding ones
+   * @brief migrateDB - Check migration status and apply any outstanding ones. The schema version
+   * (the number of applied migrations) is kept in PRAGMA user_version, so a current database is
+   * recognized without reading the migrations table, or listing the bundled migrations (their
+   * count is generated at build time, see MigrationInfo). Outstanding migrations are applied in a
+   * single transaction: either all of them are applied, or none are.
    * @return true if successful
    */
   bool migrateDB();
+  /// schemaVersion returns the database's user_version (0 for databases that predate it)
+  int schemaVersion();
+  /// availableMigrations lists the migration files (ending in ".sql") bundled with the application,
+  /// in the order they should be applied
+  static const QStringList &availableMigrations();
 
   /**
    * @brief getUnappliedMigrations retrieves a list of all of the migrations that have not been applied to the database db
@@ -140,11 +381,31 @@ class DatabaseConnection {
                                 const QVariantList &args = {});
 
   /// executeQueryNoThrow provides a safe mechanism to execute a query on the database. (Safe in the
-  /// sense that no exception is thrown). It is incumbent on the caller to inspect the
+  /// sense that no exception is thrown). Queries are forward-only: results can only be read with next(). It is incumbent on the caller to inspect the
   /// QueryResult.sucess/QueryResult.err fields to determine the actual result.
   static QueryResult executeQueryNoThrow(const QSqlDatabase& db, const QString &stmt,
                                 const QVariantList &args = {}) noexcept;
 
+  /**
+   * @brief cachedStatement returns the prepared statement for stmt, preparing and caching it
+   * on first use. Only use this for fixed sql text (i.e. not for generated IN (...) lists),
+   * otherwise the cache grows without bound.
+   * @return the prepared statement, or nullptr if the statement could not be prepared
+   */
+  QSqlQuery* cachedStatement(const QString &stmt);
+
+  /**
+   * @brief executeCachedQuery runs stmt through the prepared statement cache. Rows (if any) are
+   * handed to decodeRows, after which the statement is reset so that it can be reused.
+   * @return true if successful
+   */
+  bool executeCachedQuery(const QString &stmt, const QVariantList &args = {},
+                          const RowDecoderFunc &decodeRows = nullptr);
+
+  /// doCachedInsert is a version of executeCachedQuery that returns the last inserted id
+  /// Returns -1 if failed.
+  qint64 doCachedInsert(const QString &stmt, const QVariantList &args);
+
   /**
    * @brief doInsert is a version of executeQuery that returns the last inserted id, rather than the underlying query/response
    * @param db database to act upon
@@ -154,17 +415,6 @@ class DatabaseConnection {
    */
   static qint64 doInsert(const QSqlDatabase &db, const QString &stmt, const QVariantList &args);
 
-  /**
-   * @brief batchInsert batches multiple inserts over as few requests as possible.
-   * @param baseQuery The insert string, up to " VALUES "
-   * @param varsPerRow the number of items per row
-   * @param numRows the number of rows you wish to insert
-   * @param encodeValues A function that, given a row index, will return a QVariantList with each column's data for that row
-   * @param rowInsertTemplate An optional string that can be used to define each row's values. Defaults to (?, ..., ?)
-   */
-  void batchInsert(const QString& baseQuery, unsigned int varsPerRow, unsigned int numRows,
-                   const FieldEncoderFunc& encodeValues, QString rowInsertTemplate = QString());
-
   /**
    * @brief batchQuery batches a query with many variables into as few queries as possible.
    * Note: All variables need to be in the same location in the query.
@@ -174,8 +424,9 @@ class DatabaseConnection {
    * @param encodeValues A function that, given an index, returns a QVariantList for each variable group
    * @param decodeRows A function that can be used to retrieve the rows from the result set
    * @param variableTemplate An optional string that can be used to define how variables are handled. Defaults to ?,...,?
+   * @return true if every frame succeeded. Processing stops at the first failed frame
    */
-  void batchQuery(const QString &baseQuery, unsigned int varsPerRow, unsigned int numRows,
+  bool batchQuery(const QString &baseQuery, unsigned int varsPerRow, unsigned int numRows,
                   const FieldEncoderFunc &encodeValues, const RowDecoderFunc& decodeRows,
                   QString variableTemplate = QString());
 };
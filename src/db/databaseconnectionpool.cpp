@@ -0,0 +1,76 @@
+#include "databaseconnectionpool.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+DatabaseConnectionPool::DatabaseConnectionPool(const QString& dbPath)
+  : _dbPath(dbPath)
+{ }
+
+DatabaseConnection* DatabaseConnectionPool::connectionForCurrentThread()
+{
+    QThread* thread = QThread::currentThread();
+    {
+        QMutexLocker locker(&_lock);
+        auto found = _connections.constFind(thread);
+        if (found != _connections.constEnd())
+            return found.value();
+    }
+
+    // Opening (and migrating) happens outside of the lock, as it can be slow, and only this thread
+    // can create a connection for itself.
+    auto conn = new DatabaseConnection(_dbPath, connectionName(thread));
+    if (!conn->connect() || !conn->useWriteAheadLog()) {
+        QMutexLocker locker(&_lock);
+        _lastError = conn->errorString();
+        qWarning() << "Unable to open pooled database connection: " << _lastError;
+        conn->close();
+        delete conn;
+        QSqlDatabase::removeDatabase(connectionName(thread));
+        return nullptr;
+    }
+
+    {
+        QMutexLocker locker(&_lock);
+        _connections.insert(thread, conn);
+    }
+    // finished is emitted from the finishing thread itself, so the connection is closed by its owner
+    QObject::connect(thread, &QThread::finished, thread, [this, thread] {
+        releaseConnection(thread);
+    }, Qt::DirectConnection);
+    return conn;
+}
+
+void DatabaseConnectionPool::releaseConnectionForCurrentThread()
+{
+    releaseConnection(QThread::currentThread());
+}
+
+void DatabaseConnectionPool::releaseConnection(QThread* thread)
+{
+    DatabaseConnection* conn = nullptr;
+    {
+        QMutexLocker locker(&_lock);
+        conn = _connections.take(thread);
+    }
+    if (conn == nullptr)
+        return;
+    conn->close();
+    delete conn;
+    QSqlDatabase::removeDatabase(connectionName(thread));
+}
+
+QString DatabaseConnectionPool::lastError() const
+{
+    QMutexLocker locker(&_lock);
+    return _lastError;
+}
+
+QString DatabaseConnectionPool::connectionName(QThread* thread)
+{
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+        return Constants::defaultDbName;
+    return QStringLiteral("%1_thread_%2")
+        .arg(Constants::defaultDbName)
+        .arg(reinterpret_cast<quintptr>(thread), 0, 16);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+
+#include "databaseconnection.h"
+#include "helpers/constants.h"
+
+class QThread;
+
+/**
+ * @brief The DatabaseConnectionPool class hands out one DatabaseConnection per thread for the
+ * primary (evidence) database. Qt does not allow a QSqlDatabase to be used outside of the thread
+ * that created it, so any worker thread that needs the database should ask the pool for its own
+ * connection rather than borrowing the GUI thread's connection.
+ *
+ * Connections are opened lazily, and are closed when their owning thread finishes. Every pooled
+ * connection puts the database in WAL mode, so that readers are not blocked by a writer on another
+ * thread.
+ */
+class DatabaseConnectionPool {
+ public:
+  /// get returns the pool for the standard evidence database (see Constants::dbLocation)
+  static DatabaseConnectionPool* get() {
+    static DatabaseConnectionPool instance(Constants::dbLocation);
+    return &instance;
+  }
+
+  /**
+   * @brief connectionForCurrentThread returns the connection owned by the calling thread, opening
+   * (and migrating) a new one if needed. The connection is owned by the pool, and must only be used
+   * from the calling thread.
+   * @return the connection, or nullptr if a connection could not be established (see lastError)
+   */
+  DatabaseConnection* connectionForCurrentThread();
+
+  /// releaseConnectionForCurrentThread closes the calling thread's connection, if it has one.
+  /// Normally this happens automatically when the thread finishes; the GUI thread should call this
+  /// on shutdown.
+  void releaseConnectionForCurrentThread();
+
+  /// lastError returns the error from the most recent failed connection attempt
+  [[nodiscard]] QString lastError() const;
+  [[nodiscard]] QString getDatabasePath() const { return _dbPath; }
+
+ private:
+  explicit DatabaseConnectionPool(const QString& dbPath);
+  ~DatabaseConnectionPool() = default;
+  DatabaseConnectionPool(DatabaseConnectionPool const &) = delete;
+  void operator=(DatabaseConnectionPool const &) = delete;
+
+  void releaseConnection(QThread* thread);
+  /// connectionName returns a connection name unique to the given thread. The main thread keeps
+  /// the standard name, so that existing tooling/logs continue to refer to it.
+  static QString connectionName(QThread* thread);
+
+  QString _dbPath;
+  mutable QMutex _lock;
+  QHash<QThread*, DatabaseConnection*> _connections;
+  QString _lastError;
+};
@@ -0,0 +1,26 @@
+#include "databaseworker.h"
+
+DatabaseWorker::DatabaseWorker()
+  : _pool(std::make_unique<QThreadPool>())
+{
+    // A single thread keeps work ordered, and the thread (and so its connection) is never expired
+    _pool->setMaxThreadCount(1);
+    _pool->setExpiryTimeout(-1);
+    _pool->setObjectName(QStringLiteral("DatabaseWorker"));
+}
+
+void DatabaseWorker::shutdown()
+{
+    std::unique_ptr<QThreadPool> pool;
+    {
+        // take the pool first, so that nothing more is queued. Queued work may itself call run,
+        // so the lock cannot be held while waiting.
+        QMutexLocker lock(&_poolMutex);
+        pool = std::move(_pool);
+    }
+    if (!pool)
+        return;
+    pool->waitForDone();
+    // destroying the pool ends its thread, which releases the thread's pooled connection
+    pool.reset();
+}
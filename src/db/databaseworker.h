@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QDebug>
+#include <QFuture>
+#include <QMutex>
+#include <QPromise>
+#include <QThreadPool>
+#include <memory>
+#include <type_traits>
+
+#include "databaseconnection.h"
+#include "databaseconnectionpool.h"
+
+/**
+ * @brief The DatabaseWorker class runs database work off of the GUI thread. All work is run, in
+ * submission order, on a single dedicated thread, which holds its own (pooled) connection to the
+ * evidence database.
+ *
+ * Results are delivered through QFutures. GUI code should continue with
+ * future.then(this, [this](Result r) { ... }), so that the continuation runs on the GUI thread, and
+ * is dropped if the receiver is destroyed first.
+ */
+class DatabaseWorker {
+ public:
+  static DatabaseWorker* get() {
+    static DatabaseWorker instance;
+    return &instance;
+  }
+
+  /**
+   * @brief run queues action to be run on the database thread.
+   * @param action A callable taking a DatabaseConnection*, which it may only use for the duration
+   * of the call. Anything captured by action is used on the database thread, so only capture values
+   * (or data that is otherwise thread-safe).
+   * @return a future for the result of action. If the database cannot be opened, or the worker has
+   * been shut down, action is not run, and the future holds a default-constructed result instead.
+   */
+  template <typename Func>
+  auto run(Func &&action) -> QFuture<std::invoke_result_t<Func, DatabaseConnection*>> {
+    using Result = std::invoke_result_t<Func, DatabaseConnection*>;
+    auto promise = std::make_shared<QPromise<Result>>();
+    auto future = promise->future();
+    promise->start();
+
+    QMutexLocker lock(&_poolMutex);
+    if (!_pool) {
+      qWarning() << "Database worker has been shut down; dropping work";
+      if constexpr (!std::is_void_v<Result>)
+        promise->addResult(Result{});
+      promise->finish();
+      return future;
+    }
+    _pool->start([promise, action = std::forward<Func>(action)]() mutable {
+      auto conn = DatabaseConnectionPool::get()->connectionForCurrentThread();
+      if (conn == nullptr)
+        qWarning() << "Database worker has no connection: " << DatabaseConnectionPool::get()->lastError();
+      if constexpr (std::is_void_v<Result>) {
+        if (conn != nullptr)
+          action(conn);
+      } else {
+        promise->addResult(conn != nullptr ? action(conn) : Result{});
+      }
+      promise->finish();
+    });
+    return future;
+  }
+
+  /// shutdown waits for any queued work, then stops the database thread (closing its connection).
+  /// Call this before the application exits. Work queued afterwards (or while shutting down) is
+  /// dropped, as described in run.
+  void shutdown();
+
+ private:
+  DatabaseWorker();
+  ~DatabaseWorker() = default;
+  DatabaseWorker(DatabaseWorker const &) = delete;
+  void operator=(DatabaseWorker const &) = delete;
+
+  /// _poolMutex guards _pool itself (not the work), so that run and shutdown may race safely
+  QMutex _poolMutex;
+  std::unique_ptr<QThreadPool> _pool;
+};
@@ -0,0 +1,94 @@
+#include "dbtransaction.h"
+
+#include <QDebug>
+
+DBTransaction::DBTransaction(DatabaseConnection* db)
+  : _db(db)
+{
+    if (_db->_transactionDepth > 0)
+        _savepoint = QStringLiteral("sp_%1").arg(_db->_transactionDepth);
+
+    // IMMEDIATE takes the write lock up front, rather than failing part way through if another
+    // connection started writing in the meantime
+    _active = _savepoint.isEmpty()
+        ? run(QStringLiteral("BEGIN IMMEDIATE"))
+        : run(QStringLiteral("SAVEPOINT %1").arg(_savepoint));
+    if (_active)
+        _db->_transactionDepth++;
+}
+
+DBTransaction::~DBTransaction()
+{
+    if (_active)
+        rollback();
+}
+
+bool DBTransaction::exec(const QString &stmt, const QVariantList &args)
+{
+    if (!_active || _failed)
+        return false;
+    if (!run(stmt, args))
+        _failed = true;
+    return !_failed;
+}
+
+void DBTransaction::queue(const QString &stmt, const QVariantList &args)
+{
+    _queued.append(DBQuery(stmt, args));
+}
+
+bool DBTransaction::commit()
+{
+    if (!_active)
+        return false;
+
+    for (auto &item : _queued) {
+        if (!exec(item.query(), item.values()))
+            break;
+    }
+    _queued.clear();
+
+    if (_failed) {
+        rollback();
+        return false;
+    }
+
+    bool committed = _savepoint.isEmpty()
+        ? run(QStringLiteral("COMMIT"))
+        : run(QStringLiteral("RELEASE SAVEPOINT %1").arg(_savepoint));
+    if (!committed) {
+        rollback();
+        return false;
+    }
+    finish();
+    return true;
+}
+
+void DBTransaction::rollback()
+{
+    if (!_active)
+        return;
+    _queued.clear();
+    if (_savepoint.isEmpty()) {
+        run(QStringLiteral("ROLLBACK"));
+    } else {
+        // rolling back to a savepoint leaves it on the stack, so it still needs to be released
+        run(QStringLiteral("ROLLBACK TO SAVEPOINT %1").arg(_savepoint));
+        run(QStringLiteral("RELEASE SAVEPOINT %1").arg(_savepoint));
+    }
+    finish();
+}
+
+bool DBTransaction::run(const QString &stmt, const QVariantList &args)
+{
+    auto result = DatabaseConnection::executeQueryNoThrow(_db->_db, stmt, args);
+    if (!result.success)
+        qWarning() << "Transaction statement failed: " << stmt << result.err.text();
+    return result.success;
+}
+
+void DBTransaction::finish()
+{
+    _active = false;
+    _db->_transactionDepth--;
+}
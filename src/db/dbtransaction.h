@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QVariantList>
+
+#include "databaseconnection.h"
+
+/**
+ * @brief The DBTransaction class is a scoped unit of work on a DatabaseConnection. Statements run
+ * between construction and commit() are applied atomically, and with a single journal sync.
+ *
+ * If the transaction is destroyed without being committed (e.g. an early return after a failed
+ * statement), everything done since construction is rolled back.
+ *
+ * Transactions may be nested: the outermost transaction on a connection issues BEGIN IMMEDIATE,
+ * while inner transactions become savepoints, so an inner rollback only undoes the inner work.
+ * Nested transactions must be finished (committed or destroyed) in reverse order of creation.
+ *
+ * Transactions are bound to their connection, and so share its threading restrictions.
+ */
+class DBTransaction {
+ public:
+  explicit DBTransaction(DatabaseConnection* db);
+  ~DBTransaction();
+  DBTransaction(const DBTransaction&) = delete;
+  DBTransaction& operator=(const DBTransaction&) = delete;
+
+  /// isActive returns true if the transaction was started, and has not yet been committed or
+  /// rolled back
+  [[nodiscard]] bool isActive() const { return _active; }
+
+  /**
+   * @brief exec runs stmt immediately, within this transaction. A failure marks the transaction as
+   * failed, so that commit() will roll back instead.
+   * @return true if successful
+   */
+  bool exec(const QString &stmt, const QVariantList &args = {});
+
+  /// queue defers stmt until commit(), where all queued statements are run, in order, just before
+  /// the transaction is committed
+  void queue(const QString &stmt, const QVariantList &args = {});
+
+  /// markFailed flags the transaction as failed, for errors that happen outside of exec (e.g. a
+  /// DatabaseConnection method returning false). commit() will then roll back.
+  void markFailed() { _failed = true; }
+
+  /**
+   * @brief commit runs any queued statements, and then commits the transaction (or releases the
+   * savepoint, if nested). If the transaction has failed, it is rolled back instead.
+   * @return true if the work was committed
+   */
+  bool commit();
+
+  /// rollback undoes all work done in this transaction. Queued statements are discarded.
+  void rollback();
+
+ private:
+  DatabaseConnection* _db = nullptr;
+  /// _savepoint is the savepoint name for nested transactions; empty for the outermost one
+  QString _savepoint;
+  bool _active = false;
+  bool _failed = false;
+  QList<DBQuery> _queued;
+
+  bool run(const QString &stmt, const QVariantList &args = {});
+  void finish();
+};
@@ -0,0 +1,49 @@
+#include "evidencecursor.h"
+
+#include <QDebug>
+
+EvidenceCursor::EvidenceCursor(const EvidenceFilters &filters, bool includeTags, int pageSize)
+  : _filters(filters)
+  , _includeTags(includeTags)
+  , _pageSize(pageSize > 0 ? pageSize : defaultPageSize)
+{ }
+
+QList<model::Evidence> EvidenceCursor::nextPage(DatabaseConnection* db)
+{
+    QList<model::Evidence> page;
+    if (_atEnd)
+        return page;
+
+    QStringList keysetParts;
+    QVariantList keysetValues;
+    if (_lastRecordedDate.isValid()) {
+        keysetParts.append(QStringLiteral(" (recorded_date, id) > (?, ?) "));
+        keysetValues << _lastRecordedDate << _lastID;
+    }
+    auto suffix = QStringLiteral(" ORDER BY recorded_date, id LIMIT %1").arg(_pageSize);
+    auto dbQuery = DatabaseConnection::buildEvidenceQuery(_filters, _includeTags, keysetParts,
+                                                          keysetValues, suffix);
+
+    QSqlQuery query(db->_db);
+    query.setForwardOnly(true);
+    bool success = query.prepare(dbQuery.query());
+    const auto values = dbQuery.values();
+    for (int i = 0; success && i < values.size(); i++)
+        query.bindValue(i, values.at(i));
+    if (!success || !query.exec()) {
+        _errorString = query.lastError().text();
+        qWarning() << "Unable to read evidence page: " << _errorString;
+        _atEnd = true;
+        return page;
+    }
+
+    constexpr int recordedDateIndex = EvidenceMapper::indexOf("recorded_date");
+    page.reserve(_pageSize);
+    while (query.next()) {
+        page.append(DatabaseConnection::decodeEvidence(query, _includeTags));
+        _lastRecordedDate = query.value(recordedDateIndex);
+        _lastID = page.last().id;
+    }
+    _atEnd = page.size() < _pageSize;
+    return page;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QList>
+#include <QVariant>
+
+#include "databaseconnection.h"
+
+/**
+ * @brief The EvidenceCursor class reads the evidence matching a set of filters one page at a time,
+ * ordered by (recorded_date, id). Each page is a separate keyset query that picks up after the
+ * last row of the previous page, so the full result set is never held in memory, and no read
+ * transaction stays open between pages.
+ *
+ * Evidence added or removed between pages may or may not be seen, as with any keyset pagination.
+ * The cursor only holds the position, not a connection, so pages may be read on another thread
+ * (e.g. through DatabaseWorker), provided that only one page is read at a time.
+ */
+class EvidenceCursor {
+ public:
+  inline static const int defaultPageSize = 500;
+
+  /**
+   * @brief EvidenceCursor prepares a cursor over the evidence matching filters. No query is run
+   * until nextPage is called.
+   * @param filters The filters to apply
+   * @param includeTags if true, each evidence has its tags populated
+   * @param pageSize The (maximum) number of rows returned by each call to nextPage
+   */
+  explicit EvidenceCursor(const EvidenceFilters &filters, bool includeTags = false,
+                          int pageSize = defaultPageSize);
+
+  /// atEnd returns true once all of the evidence has been read (or an error occurred)
+  [[nodiscard]] bool atEnd() const { return _atEnd; }
+
+  /// nextPage retrieves the next (up to) pageSize rows from db. Returns an empty list once atEnd
+  /// is true.
+  QList<model::Evidence> nextPage(DatabaseConnection* db);
+
+  /// errorString returns the error that stopped the cursor, or an empty string if none occurred
+  [[nodiscard]] QString errorString() const { return _errorString; }
+
+ private:
+  EvidenceFilters _filters;
+  bool _includeTags = false;
+  int _pageSize = defaultPageSize;
+  bool _atEnd = false;
+  QString _errorString;
+
+  /// _lastRecordedDate is the raw (as stored) recorded_date of the last row read. The raw value is
+  /// kept, rather than a QDateTime, so that the keyset comparison matches sqlite's own ordering.
+  QVariant _lastRecordedDate;
+  qint64 _lastID = 0;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+#include <QDateTime>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTimeZone>
+#include <QVariant>
+
+/**
+ * The row mapper layer describes, at compile time, which column feeds which model field. Rows are
+ * then decoded by column index, rather than by looking up each column by name (a hash lookup per
+ * value, per row).
+ *
+ * Usage:
+ *   using ThingMapper = RowMapper<Thing, Column<"id", &Thing::id>, Column<"name", &Thing::name>>;
+ *   auto sql = QStringLiteral("SELECT %1 FROM things").arg(ThingMapper::columnList());
+ *   ... ThingMapper::read(query);
+ *
+ * The select list must come from columnList() (or otherwise list the columns in the same order),
+ * since decoding relies purely on column position.
+ */
+namespace db {
+
+/// ColumnName allows a string literal to be used as a template argument
+template <std::size_t N>
+struct ColumnName {
+  constexpr ColumnName(const char (&name)[N]) { std::copy_n(name, N, value); }
+  constexpr std::string_view view() const { return std::string_view(value, N - 1); }
+  char value[N];
+};
+
+/// MemberTraits splits a pointer-to-member into its model and field types
+template <auto Member>
+struct MemberTraits;
+
+template <typename Model, typename Field, Field Model::*Member>
+struct MemberTraits<Member> {
+  using model_type = Model;
+  using field_type = Field;
+};
+
+/// fromVariant converts a column value to the field's type
+template <typename T>
+inline T fromVariant(const QVariant &value) {
+  if constexpr (std::is_same_v<T, QDateTime>) {
+    // all dates are stored as UTC, but sqlite has no notion of timezones
+    auto rtn = value.toDateTime();
+    rtn.setTimeZone(QTimeZone::UTC);
+    return rtn;
+  } else if constexpr (std::is_same_v<T, QString>) {
+    return value.toString();
+  } else if constexpr (std::is_integral_v<T>) {
+    return static_cast<T>(value.toLongLong());
+  } else {
+    return value.value<T>();
+  }
+}
+
+/// Column binds a column name to a model field
+template <ColumnName Name, auto Member>
+struct Column {
+  using model_type = typename MemberTraits<Member>::model_type;
+  using field_type = typename MemberTraits<Member>::field_type;
+  static constexpr std::string_view name = Name.view();
+
+  static void read(model_type &model, const QVariant &value) {
+    model.*Member = fromVariant<field_type>(value);
+  }
+};
+
+template <typename Model, typename... Columns>
+class RowMapper {
+  static_assert((std::is_same_v<Model, typename Columns::model_type> && ...),
+                "All columns must belong to the mapped model");
+
+ public:
+  static constexpr int columnCount = sizeof...(Columns);
+
+  /// columnList returns the column names, in decode order, for use in a SELECT or INSERT
+  static QString columnList() {
+    static const QString list = [] {
+      QStringList names;
+      (names.append(QString::fromLatin1(Columns::name.data(), Columns::name.size())), ...);
+      return names.join(QStringLiteral(", "));
+    }();
+    return list;
+  }
+
+  /// indexOf returns the position of the named column, or -1 if the mapper has no such column
+  static constexpr int indexOf(std::string_view name) {
+    int index = 0;
+    int found = -1;
+    ((Columns::name == name ? (found = index, ++index) : ++index), ...);
+    return found;
+  }
+
+  /**
+   * @brief read decodes the current row of query into a new model.
+   * @param query A query positioned on a valid row
+   * @param offset The index of the first mapped column (for queries that select other columns first)
+   */
+  static Model read(const QSqlQuery &query, int offset = 0) {
+    Model rtn{};
+    int index = offset;
+    (Columns::read(rtn, query.value(index++)), ...);
+    return rtn;
+  }
+};
+
+}  // namespace db
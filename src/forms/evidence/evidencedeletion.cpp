@@ -0,0 +1,53 @@
+#include "evidencedeletion.h"
+
+#include <QDir>
+#include <QFile>
+#include <QPromise>
+#include <QThreadPool>
+#include <memory>
+
+#include "db/databaseworker.h"
+#include "helpers/file_helpers.h"
+
+QFuture<EvidenceDeletion::Result> EvidenceDeletion::deleteEvidence(const QList<qint64>& ids) {
+  return DatabaseWorker::get()->run([ids](DatabaseConnection* conn) {
+    Result rtn;
+    QList<model::Evidence> deleted;
+    rtn.success = conn->deleteEvidence(ids, deleted);
+    if (!rtn.success) {
+      rtn.errorText = conn->errorString();
+      return rtn;
+    }
+    auto skippedPaths = conn->getEvidencePathsInUse(deleted);
+    for (const auto& evi : deleted) {
+      rtn.ids.insert(evi.id);
+      if (!skippedPaths.contains(evi.path)) {
+        skippedPaths.insert(evi.path);  // shared files only need to be removed once
+        rtn.unusedPaths.append(evi.path);
+      }
+    }
+    return rtn;
+  });
+}
+
+QFuture<QString> EvidenceDeletion::removeFiles(const QStringList& paths) {
+  auto promise = std::make_shared<QPromise<QString>>();
+  auto future = promise->future();
+  promise->setProgressRange(0, paths.size());
+  promise->start();
+  QThreadPool::globalInstance()->start([promise, paths] {
+    QSet<QString> parentDirs;
+    for (int i = 0; i < paths.size(); i++) {
+      const auto& path = paths.at(i);
+      if (!QFile::remove(path) && QFile::exists(path))
+        promise->addResult(path);
+      parentDirs.insert(FileHelpers::getDirname(path));
+      promise->setProgressValue(i + 1);
+    }
+    // rmdir only removes empty directories, so directories with other evidence are left alone
+    for (const auto& dir : std::as_const(parentDirs))
+      QDir().rmdir(dir);
+    promise->finish();
+  });
+  return future;
+}
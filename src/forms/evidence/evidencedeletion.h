@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QFuture>
+#include <QList>
+#include <QSet>
+#include <QStringList>
+
+/**
+ * @brief EvidenceDeletion removes evidence without blocking the GUI thread. The database rows are
+ * deleted first (see deleteEvidence), and then the files that are no longer in use are removed on
+ * the global thread pool (see removeFiles).
+ */
+class EvidenceDeletion {
+ public:
+  /// Result is the database half of a deletion
+  struct Result {
+    bool success = false;
+    QString errorText;
+    /// ids is the evidence that was removed from the database
+    QSet<qint64> ids;
+    /// unusedPaths are files no longer referred to by any evidence, and so can be removed
+    QStringList unusedPaths;
+  };
+
+  /// deleteEvidence deletes the provided ids from the database, in one transaction, on the
+  /// database worker
+  static QFuture<Result> deleteEvidence(const QList<qint64>& ids);
+
+  /// removeFiles removes each of paths (and then any parent directories left empty) on the global
+  /// thread pool. Progress is the number of paths processed so far, and the results are the paths
+  /// that could not be removed.
+  static QFuture<QString> removeFiles(const QStringList& paths);
+};
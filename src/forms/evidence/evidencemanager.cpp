@@ -1,21 +1,28 @@
 #include "evidencemanager.h"
 
+#include <algorithm>
+
 #include <QApplication>
 #include <QCheckBox>
 #include <QClipboard>
+#include <QDir>
+#include <QFutureWatcher>
 #include <QGridLayout>
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QPushButton>
 #include <QRandomGenerator>
+#include <QSet>
 #include <QTableWidgetItem>
 
 #include "appconfig.h"
+#include "db/databaseworker.h"
 #include "dtos/tag.h"
+#include "forms/evidence/evidencedeletion.h"
 #include "forms/evidence_filter/evidencefilter.h"
 #include "forms/evidence_filter/evidencefilterform.h"
-#include "helpers/netman.h"
-#include "helpers/cleanupreply.h"
+#include "helpers/file_helpers.h"
+#include "uploadqueue.h"
 
 enum ColumnIndexes {
   COL_DATE_CAPTURED = 0,
@@ -29,6 +36,9 @@ enum ColumnIndexes {
   COL_ERROR_MSG
 };
 
+/// SubmittedRole holds (on the COL_SUBMITTED item) whether the row's evidence has been uploaded
+constexpr int SubmittedRole = Qt::UserRole + 1;
+
 EvidenceManager::EvidenceManager(DatabaseConnection* db, QWidget* parent)
     : AShirtDialog(parent)
     , db(db)
@@ -36,6 +46,7 @@ EvidenceManager::EvidenceManager(DatabaseConnection* db, QWidget* parent)
     , filterForm(new EvidenceFilterForm(this))
     , evidenceTableContextMenu(new QMenu(this))
     , submitEvidenceAction(new QAction(tr("Submit Evidence"), evidenceTableContextMenu))
+    , submitAllAction(new QAction(tr("Submit All Matching Evidence"), evidenceTableContextMenu))
     , copyPathToClipboardAction(new QAction(tr("Copy Path"), evidenceTableContextMenu))
     , filterTextBox(new QLineEdit(this))
     , editFiltersButton(new QPushButton(tr("Edit Filters"), this))
@@ -45,14 +56,13 @@ EvidenceManager::EvidenceManager(DatabaseConnection* db, QWidget* parent)
     , cancelEditButton(new QPushButton(tr("Cancel"), this))
     , evidenceEditor(new EvidenceEditor(this->db, this))
     , loadingAnimation(new QProgressIndicator(this))
+    , statsLabel(new QLabel(this))
 {
   buildUi();
   wireUi();
 }
 
-EvidenceManager::~EvidenceManager() {
-  cleanUpReply(&uploadAssetReply);
-}
+EvidenceManager::~EvidenceManager() = default;
 
 void EvidenceManager::buildEvidenceTableUi() {
   evidenceTable->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -72,6 +82,7 @@ void EvidenceManager::buildEvidenceTableUi() {
 void EvidenceManager::buildUi() {
 
   evidenceTableContextMenu->addAction(submitEvidenceAction);
+  evidenceTableContextMenu->addAction(submitAllAction);
   evidenceTableContextMenu->addAction(tr("Delete Evidence"), this, &EvidenceManager::deleteEvidenceTriggered);
   evidenceTableContextMenu->addAction(copyPathToClipboardAction);
   evidenceTableContextMenu->addSeparator();
@@ -111,7 +122,7 @@ void EvidenceManager::buildUi() {
        |                     Evidence Editor                    |
        |                                                        |
        +---------------+-------------+------------+-------------+
-    3  | Loading Ani   | Hor Spacer  | Cancel Btn | Edit Btn    |
+    3  | Loading Ani   | Stats Label | Cancel Btn | Edit Btn    |
        +---------------+-------------+------------+-------------+
   */
 
@@ -127,7 +138,8 @@ void EvidenceManager::buildUi() {
   gridLayout->addWidget(evidenceEditor, 2, 0, 1, gridLayout->columnCount());
 
   gridLayout->addWidget(loadingAnimation, 3, 0);
-  gridLayout->addItem(new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Minimum), 3, 1);
+  statsLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
+  gridLayout->addWidget(statsLabel, 3, 1);
   gridLayout->addWidget(cancelEditButton, 3, 2);
   gridLayout->addWidget(editButton, 3, 3);
   setLayout(gridLayout);
@@ -149,6 +161,7 @@ void EvidenceManager::wireUi() {
   connect(cancelEditButton, btnClicked, this, &EvidenceManager::cancelEditEvidenceButtonClicked);
 
   connect(submitEvidenceAction, actionTriggered, this, &EvidenceManager::submitEvidenceTriggered);
+  connect(submitAllAction, actionTriggered, this, &EvidenceManager::submitAllTriggered);
   connect(copyPathToClipboardAction, actionTriggered, this, &EvidenceManager::copyPathTriggered);
 
   connect(filterForm, &EvidenceFilterForm::evidenceSet, this, &EvidenceManager::applyFilterForm);
@@ -157,15 +170,20 @@ void EvidenceManager::wireUi() {
   connect(evidenceTable, &QTableWidget::currentCellChanged, this, &EvidenceManager::onRowChanged);
   connect(evidenceTable, &QTableWidget::customContextMenuRequested, this,
           &EvidenceManager::openTableContextMenu);
+  connect(UploadQueue::get(), &UploadQueue::uploadStateChanged, this,
+          &EvidenceManager::onUploadStateChanged);
 }
 
 void EvidenceManager::editEvidenceButtonClicked() {
   if(editButton->text() == tr("Save")) {
-    evidenceEditor->saveEvidence();
-    cancelEditEvidenceButtonClicked();
-    refreshRow(evidenceTable->currentRow());
-    // restore default form action
-    applyFilterButton->setDefault(true);
+    // saveData refreshes the row once the edits are saved
+    saveData().then(this, [this](bool saved) {
+      if (!saved)
+        return;
+      cancelEditEvidenceButtonClicked();
+      // restore default form action
+      applyFilterButton->setDefault(true);
+    });
   }
   else {
     // remove default form action to prevent accidental reloading of evidence
@@ -177,11 +195,14 @@ void EvidenceManager::editEvidenceButtonClicked() {
 }
 
 void EvidenceManager::cancelEditEvidenceButtonClicked() {
+  // only an edit in progress has anything to revert
+  const bool editing = editButton->text() == tr("Save");
   evidenceEditor->setEnabled(false);
   cancelEditButton->setVisible(false);
   //refreshRow(evidenceTable->currentRow());
   editButton->setText(tr("Edit"));
-  evidenceEditor->revert();
+  if (editing)
+    evidenceEditor->revert();
 }
 
 void EvidenceManager::showEvent(QShowEvent* evt) {
@@ -192,21 +213,94 @@ void EvidenceManager::showEvent(QShowEvent* evt) {
 
 void EvidenceManager::submitEvidenceTriggered()
 {
-    loadingAnimation->startAnimation();
-    evidenceTable->setEnabled(false);  // prevent switching evidence while one is being submitted.
-    if (!saveData())
-        return;
-    evidenceIDForRequest = selectedRowEvidenceID();
-    model::Evidence evi = db->getEvidenceDetails(evidenceIDForRequest);
-    if(evi.id == -1) {
-        evidenceTable->setEnabled(true);
-        loadingAnimation->stopAnimation();
-        QMessageBox::warning(this, tr("Cannot submit evidence"),
-                             tr("Could not retrieve data. Please try again."));
+    QList<qint64> ids;
+    const auto selectedRows = evidenceTable->selectionModel()->selectedRows();
+    for (const auto& index : selectedRows) {
+        if (!evidenceTable->item(index.row(), COL_SUBMITTED)->data(SubmittedRole).toBool())
+            ids.append(index.data(Qt::UserRole).toLongLong());
+    }
+    saveData().then(this, [this, ids](bool saved) {
+        if (saved)
+            submitSet(ids);
+    });
+}
+
+void EvidenceManager::submitAllTriggered()
+{
+    // the table may not have every page loaded yet, so find the evidence from the filters instead
+    auto filters = EvidenceFilters::parseFilter(filterTextBox->text());
+    DatabaseWorker::get()->run([filters](DatabaseConnection* conn) {
+        QList<qint64> ids;
+        EvidenceCursor cursor(filters);
+        while (!cursor.atEnd()) {
+            const auto page = cursor.nextPage(conn);
+            for (const auto& evi : page) {
+                if (evi.uploadDate.isNull())
+                    ids.append(evi.id);
+            }
+        }
+        return ids;
+    }).then(this, [this](const QList<qint64>& ids) {
+        if (ids.isEmpty()) {
+            QMessageBox::information(this, tr("Submit Evidence"),
+                                     tr("All of the matching evidence has already been submitted."));
+            return;
+        }
+        auto reply = QMessageBox::question(this, tr("Submit Evidence"),
+                                           tr("Submit %n unsubmitted evidence?", nullptr, int(ids.size())),
+                                           QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+        if (reply == QMessageBox::Yes)
+            submitSet(ids);
+    });
+}
+
+void EvidenceManager::submitSet(const QList<qint64>& ids)
+{
+    if (ids.isEmpty())
         return;
+    QList<qint64> added;
+    for (auto id : ids) {
+        if (!pendingSubmissions.contains(id)) {
+            pendingSubmissions.insert(id);
+            added.append(id);
+            submissionTotal++;
+        }
+    }
+    loadingAnimation->startAnimation();
+    showSubmissionProgress();
+    UploadQueue::get()->enqueue(ids).then(this, [this, added](const QList<qint64>& queued) {
+        // skipped evidence (e.g. already submitted) never reports back, so stop waiting for it
+        const QSet<qint64> queuedIDs(queued.cbegin(), queued.cend());
+        for (auto id : added) {
+            if (!queuedIDs.contains(id) && pendingSubmissions.remove(id))
+                submissionTotal--;
+        }
+        if (pendingSubmissions.isEmpty())
+            finishSubmissions();
+        else
+            showSubmissionProgress();
+    });
+}
+
+void EvidenceManager::showSubmissionProgress()
+{
+    statsLabel->setText(tr("Submitting evidence: %1 of %2 done")
+                            .arg(submissionTotal - pendingSubmissions.size())
+                            .arg(submissionTotal));
+}
+
+void EvidenceManager::finishSubmissions()
+{
+    loadingAnimation->stopAnimation();
+    refreshStats(EvidenceFilters::parseFilter(filterTextBox->text()).operationSlug);
+    if (submissionFailures > 0) {
+        QMessageBox::warning(this, tr("Cannot Submit Evidence"),
+                             tr("%n evidence could not be uploaded. Check your connection and try again.\n"
+                                "(Error: %1)", nullptr, submissionFailures).arg(lastSubmissionError));
     }
-    uploadAssetReply = NetMan::uploadAsset(evi);
-    connect(uploadAssetReply, &QNetworkReply::finished, this, &EvidenceManager::onUploadComplete);
+    submissionTotal = 0;
+    submissionFailures = 0;
+    lastSubmissionError.clear();
 }
 
 void EvidenceManager::deleteEvidenceTriggered() {
@@ -236,68 +330,80 @@ void EvidenceManager::deleteAllTriggered() {
   }
 }
 
-/// parentDir returns the parent directory for a given file path.
-/// example: Input: path/to/file.txt Output: path/to
-static QString parentDir(QString path) {
-  auto lastSlash = path.lastIndexOf("/");
-  return path.left(lastSlash);
+void EvidenceManager::deleteSet(QList<qint64> ids) {
+  if (ids.isEmpty())
+    return;
+  evidenceTable->setEnabled(false);
+  EvidenceDeletion::deleteEvidence(ids).then(this, [this](const EvidenceDeletion::Result& deleted) {
+    evidenceTable->setEnabled(true);
+    onEvidenceDeleted(deleted);
+  });
 }
 
-void EvidenceManager::deleteSet(QList<qint64> ids) {
-  QList<DeleteEvidenceResponse> responses = evidenceEditor->deleteEvidence(ids);
-  QStringList undeletedFiles;
-  bool removedAllDbRecords = true;
-  QStringList paths;
-  for(const auto& response : responses) {
-    if (!response.fileDeleteSuccess) {
-      undeletedFiles << response.model.path;
-    }
-    removedAllDbRecords = removedAllDbRecords && response.dbDeleteSuccess;
-    auto parentPath = parentDir(response.model.path);
-    if (!paths.contains(parentPath)) {
-      paths << parentPath;
-    }
+void EvidenceManager::onEvidenceDeleted(const EvidenceDeletion::Result& deleted) {
+  if (!deleted.success) {
+    qWarning() << "Could not delete evidence from internal database. Error: " << deleted.errorText;
+    QMessageBox::warning(this, tr("Could not complete evidence deletion"),
+                         tr("Unable to delete evidence: %1").arg(deleted.errorText));
+    return;
   }
 
-  if (!removedAllDbRecords) {
-    qWarning() << "Could not delete evidence from internal database. Errors: ";
-    for (const auto& resp : responses) {
-      if (!resp.dbDeleteSuccess) {
-        qWarning() << "  id: " << resp.model.id << " ;; Error: "<< resp.errorText;
-      }
-    }
+  // update the table in place, rather than reloading it
+  for (int row = evidenceTable->rowCount() - 1; row >= 0; row--) {
+    auto rowItem = evidenceTable->item(row, 0);
+    if (rowItem != nullptr && deleted.ids.contains(rowItem->data(Qt::UserRole).toLongLong()))
+      evidenceTable->removeRow(row);
   }
+  // deleted evidence is dropped from the upload queue, so stop waiting on it
+  if (!pendingSubmissions.isEmpty() && pendingSubmissions.intersects(deleted.ids)) {
+    pendingSubmissions.subtract(deleted.ids);
+    if (pendingSubmissions.isEmpty())
+      finishSubmissions();
+  }
+  refreshStats(EvidenceFilters::parseFilter(filterTextBox->text()).operationSlug);
 
-  if (undeletedFiles.length() > 0) {
-    bool logWritten = true;
-    auto errLogPath = QStringLiteral("%1/%2.log")
-            .arg(AppConfig::value(CONFIG::EVIDENCEREPO)
-            , QDateTime::currentDateTime().toMSecsSinceEpoch());
-
-    QByteArray dataToWrite = tr("Paths to files that could not be deleted: \n\n %1")
-              .arg(undeletedFiles.join(QStringLiteral("\n"))).toUtf8();
-    logWritten = FileHelpers::writeFile(errLogPath, dataToWrite);
+  if (deleted.unusedPaths.isEmpty())
+    return;
+  auto total = deleted.unusedPaths.size();
+  auto watcher = new QFutureWatcher<QString>(this);
+  connect(watcher, &QFutureWatcher<QString>::progressValueChanged, this, [this, total](int done) {
+    statsLabel->setText(tr("Removing evidence files: %1 of %2").arg(done).arg(total));
+  });
+  connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher] {
+    const auto undeletedFiles = watcher->future().results();
+    watcher->deleteLater();
+    refreshStats(EvidenceFilters::parseFilter(filterTextBox->text()).operationSlug);
+    if (!undeletedFiles.isEmpty())
+      reportUndeletedFiles(undeletedFiles);
+  });
+  watcher->setFuture(EvidenceDeletion::removeFiles(deleted.unusedPaths));
+}
 
-    QString msg = tr("Some files could not be deleted.");
-    if (logWritten)
-        msg.append(tr(" A list of the excluded files can be found here: \n").arg(errLogPath));
+void EvidenceManager::reportUndeletedFiles(const QStringList& undeletedFiles) {
+  auto errLogPath = QStringLiteral("%1/%2.log")
+          .arg(AppConfig::value(CONFIG::EVIDENCEREPO)
+          , QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch()));
 
-    QMessageBox::warning(this, tr("Could not complete evidence deletion"), msg);
-  }
+  QByteArray dataToWrite = tr("Paths to files that could not be deleted: \n\n %1")
+            .arg(undeletedFiles.join(QStringLiteral("\n"))).toUtf8();
+  bool logWritten = FileHelpers::writeFile(errLogPath, dataToWrite);
 
-  for (const auto& p : paths) {
-    auto path = QDir(p);
-    auto dirName = path.dirName();
-    path.cdUp();
-    path.rmdir(dirName);
-  }
+  QString msg = tr("Some files could not be deleted.");
+  if (logWritten)
+      msg.append(tr(" A list of the excluded files can be found here: \n%1").arg(errLogPath));
 
-  loadEvidence();
+  QMessageBox::warning(this, tr("Could not complete evidence deletion"), msg);
 }
 
 void EvidenceManager::copyPathTriggered() {
-  auto evidence = db->getEvidenceDetails(selectedRowEvidenceID());
-  QApplication::clipboard()->setText(evidence.path);
+  const auto evidenceID = selectedRowEvidenceID();
+  DatabaseWorker::get()->run([evidenceID](DatabaseConnection* conn) {
+    return conn->getEvidenceDetails(evidenceID).path;
+  }).then(this, [](const QString& path) {
+    if (path.isEmpty())
+      return;
+    QApplication::clipboard()->setText(path);
+  });
 }
 
 void EvidenceManager::openTableContextMenu(QPoint pos) {
@@ -307,8 +413,11 @@ void EvidenceManager::openTableContextMenu(QPoint pos) {
   }
   bool singleItemSelected = selectedRowCount == 1;
   copyPathToClipboardAction->setEnabled(singleItemSelected);
-  bool wasSubmitted = !evidenceEditor->encodeEvidence().uploadDate.isNull();
-  submitEvidenceAction->setEnabled(singleItemSelected && !wasSubmitted);
+  const auto selectedRows = evidenceTable->selectionModel()->selectedRows();
+  bool anyUnsubmitted = std::any_of(selectedRows.cbegin(), selectedRows.cend(), [this](const QModelIndex& index) {
+    return !evidenceTable->item(index.row(), COL_SUBMITTED)->data(SubmittedRole).toBool();
+  });
+  submitEvidenceAction->setEnabled(anyUnsubmitted);
   evidenceTableContextMenu->popup(evidenceTable->viewport()->mapToGlobal(pos));
 }
 
@@ -326,27 +435,74 @@ void EvidenceManager::applyFilterForm(const EvidenceFilters& filter) {
 
 void EvidenceManager::loadEvidence()
 {
-    qint64 reselectId = -1;
+    reselectID = -1;
     if (evidenceTable->selectedItems().size() > 0) {
-        reselectId = selectedRowEvidenceID();
+        reselectID = selectedRowEvidenceID();
     }
 
     evidenceTable->clearContents();
+    evidenceTable->setRowCount(0);
 
     auto filter = EvidenceFilters::parseFilter(filterTextBox->text());
-    QList<model::Evidence> operationEvidence = db->getEvidenceWithFilters(filter);
-    if(db->lastError().isValid()){
-        qWarning() << "Could not retrieve evidence for operation. Error: " << db->lastError().text();
+    evidenceCursor = std::make_shared<EvidenceCursor>(filter);
+    loadGeneration++;
+    loadEvidencePage(loadGeneration);
+    refreshStats(filter.operationSlug);
+}
+
+void EvidenceManager::refreshStats(const QString& operationSlug)
+{
+    auto slug = operationSlug.isEmpty() ? AppConfig::operationSlug() : operationSlug;
+    if (slug.isEmpty()) {
+        statsLabel->clear();
+        return;
     }
-    evidenceTable->setRowCount(operationEvidence.size());
+    DatabaseWorker::get()->run([slug](DatabaseConnection* conn) {
+        return conn->getEvidenceStats(slug);
+    }).then(this, [this, slug](const model::EvidenceStats& stats) {
+        // submission progress takes precedence, until the submission is finished
+        if (pendingSubmissions.isEmpty())
+            statsLabel->setText(tr("%1: %2").arg(slug, stats.summary()));
+    });
+}
+
+void EvidenceManager::loadEvidencePage(quint64 generation)
+{
+    // a newer load (e.g. a filter change) replaced the cursor this page was requested for
+    if (generation != loadGeneration || !evidenceCursor)
+        return;
+
+    auto cursor = evidenceCursor;
+    DatabaseWorker::get()->run([cursor](DatabaseConnection* conn) {
+        return cursor->nextPage(conn);
+    }).then(this, [this, generation, cursor](const QList<model::Evidence>& page) {
+        if (generation != loadGeneration)
+            return;
+        if (!cursor->errorString().isEmpty()) {
+            qWarning() << "Could not retrieve evidence for operation. Error: " << cursor->errorString();
+        }
+        appendEvidencePage(page);
+        if (cursor->atEnd()) {
+            evidenceCursor.reset();
+            return;
+        }
+        loadEvidencePage(generation);
+    });
+}
+
+void EvidenceManager::appendEvidencePage(const QList<model::Evidence>& page)
+{
+    int firstRow = evidenceTable->rowCount();
+    evidenceTable->setRowCount(firstRow + page.size());
 
     // removing sorting temporarily to solve a bug (per qt: not a bug)
     // Essentially, _not_ doing this breaks reloading the table. Mostly empty cells appear.
     // from: https://stackoverflow.com/a/8904287/4262552
     // see also: https://bugreports.qt.io/browse/QTBUG-75479
     evidenceTable->setSortingEnabled(false);
-    for (size_t row = 0; row < operationEvidence.size(); row++) {
-        auto evi = operationEvidence.at(row);
+    for (int i = 0; i < page.size(); i++) {
+        int row = firstRow + i;
+        const auto& evi = page.at(i);
         auto rowData = buildBaseEvidenceRow(evi.id);
 
         evidenceTable->setItem(row, COL_OPERATION, rowData.operation);
@@ -362,17 +518,22 @@ void EvidenceManager::loadEvidence()
         setRowText(row, evi);
     }
     evidenceTable->setSortingEnabled(true);
-    if (evidenceTable->rowCount() > 0) {
-        // try to reselect the last viewed evidence, if it's still in the list
-        int selectRow = 0;
+
+    // try to reselect the last viewed evidence, if it's in this page. Otherwise, fall back to the
+    // first row once the first page arrives.
+    auto reselectIt = std::find_if(page.cbegin(), page.cend(), [this](const model::Evidence& evi) {
+        return evi.id == reselectID;
+    });
+    if (reselectIt != page.cend()) {
         for (int rowIndex = 0; rowIndex < evidenceTable->rowCount(); rowIndex++) {
             auto evidenceID = evidenceTable->item(rowIndex, 0)->data(Qt::UserRole).toLongLong();
-            if(evidenceID == reselectId) {
-                selectRow = rowIndex;
+            if(evidenceID == reselectID) {
+                evidenceTable->setCurrentCell(rowIndex, 0);
                 break;
             }
         }
-        evidenceTable->setCurrentCell(selectRow, 0);
+    } else if (firstRow == 0 && evidenceTable->rowCount() > 0) {
+        evidenceTable->setCurrentCell(0, 0);
     }
 }
 
@@ -421,31 +582,68 @@ void EvidenceManager::setRowText(int row, const model::Evidence& model) {
 
   auto uploadDateText = model.uploadDate.isNull() ? QStringLiteral("Never") : model.uploadDate.toLocalTime().toString(dateFormat);
   setColText(COL_DATE_SUBMITTED, uploadDateText);
+  evidenceTable->item(row, COL_SUBMITTED)->setData(SubmittedRole, !model.uploadDate.isNull());
+
+  // evidence still moving through the upload queue shows its progress instead
+  auto liveState = liveUploadStates.constFind(model.id);
+  if (liveState != liveUploadStates.cend() && model.uploadDate.isNull())
+    showUploadState(row, liveState.value(), QString());
+}
+
+void EvidenceManager::showUploadState(int row, model::UploadState state, const QString& errorText) {
+  QString text;
+  switch (state) {
+    case model::UploadState::QUEUED:
+      text = errorText.isEmpty() ? tr("Queued") : tr("Retrying");
+      break;
+    case model::UploadState::UPLOADING:
+      text = tr("Uploading");
+      break;
+    default:
+      return;  // final states are read back from the database
+  }
+  evidenceTable->item(row, COL_SUBMITTED)->setText(text);
+  if (!errorText.isEmpty())
+    evidenceTable->item(row, COL_ERROR_MSG)->setText(errorText);
 }
 
 void EvidenceManager::refreshRow(int row)
 {
-    auto evidenceID = selectedRowEvidenceID();
-    auto updatedData = db->getEvidenceDetails(evidenceID);
-    if (updatedData.id != -1) {
-        setRowText(row, updatedData);
+    auto item = evidenceTable->item(row, 0);
+    if (item == nullptr)
         return;
-    }
-    qWarning() << "Could not refresh table row: " << db->errorString();
+    auto evidenceID = item->data(Qt::UserRole).toLongLong();
+    DatabaseWorker::get()->run([evidenceID](DatabaseConnection* conn) {
+        return conn->getEvidenceDetails(evidenceID);
+    }).then(this, [this, row, evidenceID](const model::Evidence& updatedData) {
+        // the table may have been reloaded (or re-sorted) in the meantime
+        auto rowItem = evidenceTable->item(row, 0);
+        if (rowItem == nullptr || rowItem->data(Qt::UserRole).toLongLong() != evidenceID)
+            return;
+        if (updatedData.id <= 0) {
+            qWarning() << "Could not refresh table row for evidence: " << evidenceID;
+            return;
+        }
+        setRowText(row, updatedData);
+        // the row's status may have changed (e.g. it was submitted)
+        refreshStats(EvidenceFilters::parseFilter(filterTextBox->text()).operationSlug);
+    });
 }
 
-bool EvidenceManager::saveData() {
-  auto saveResponse = evidenceEditor->saveEvidence();
-  if (saveResponse.actionSucceeded) {
-    refreshRow(evidenceTable->currentRow());
-    return true;
-  }
+QFuture<bool> EvidenceManager::saveData() {
+  const auto row = evidenceTable->currentRow();
+  return evidenceEditor->saveEvidence().then(this, [this, row](const SaveEvidenceResponse& saveResponse) {
+    if (saveResponse.actionSucceeded) {
+      refreshRow(row);
+      return true;
+    }
 
-  QMessageBox::warning(this, tr("Cannot Save"),
-                       tr("Unable to save evidence data.\n"
-                       "You can try uploading directly to the website. File Location:\n%1")
-                        .arg(saveResponse.model.path));
-  return false;
+    QMessageBox::warning(this, tr("Cannot Save"),
+                         tr("Unable to save evidence data.\n"
+                         "You can try uploading directly to the website. File Location:\n%1")
+                          .arg(saveResponse.model.path));
+    return false;
+  });
 }
 
 void EvidenceManager::openFiltersMenu() {
@@ -467,47 +665,75 @@ void EvidenceManager::onRowChanged(int currentRow, int _currentColumn, int _prev
     return;
   }
 
-  auto evidence = db->getEvidenceDetails(selectedRowEvidenceID());
-
-  auto readonly = evidence.uploadDate.isValid();
-  submitEvidenceAction->setEnabled(!readonly);
-  Q_EMIT evidenceChanged(evidence.id, true);
+  // nothing is editable until the evidence has been read
+  editButton->setEnabled(false);
+  const auto evidenceID = selectedRowEvidenceID();
+  DatabaseWorker::get()->run([evidenceID](DatabaseConnection* conn) {
+    return conn->getEvidenceDetails(evidenceID);
+  }).then(this, [this, evidenceID](const model::Evidence& evidence) {
+    // the selection may have moved on in the meantime
+    if (evidenceTable->currentItem() == nullptr || selectedRowEvidenceID() != evidenceID)
+      return;
+
+    auto readonly = evidence.uploadDate.isValid();
+    submitEvidenceAction->setEnabled(!readonly);
+    // the editor is given the evidence already read here, rather than reading it again
+    evidenceEditor->updateEvidence(evidence, true);
+
+    int selectedRowCount = evidenceTable->selectionModel()->selectedRows().count();
+    if (selectedRowCount > 1) {
+      editButton->setEnabled(false);
+      editButton->setToolTip(tr("Only one evidence item may be edited at once."));
+    }
+    else {
+      this->editButton->setEnabled(!readonly);
+      this->editButton->setToolTip(readonly
+                                       ? tr("Edit is only available on unsubmitted evidence")
+                                       : tr("Update this data before submitting"));
+    }
+  });
+}
 
-  int selectedRowCount = evidenceTable->selectionModel()->selectedRows().count();
-  if (selectedRowCount > 1) {
-    editButton->setEnabled(false);
-    editButton->setToolTip(tr("Only one evidence item may be edited at once."));
+void EvidenceManager::onUploadStateChanged(qint64 evidenceID, model::UploadState state,
+                                           const QString& errorText) {
+  const bool finished = state == model::UploadState::DONE || state == model::UploadState::FAILED;
+  if (finished)
+    liveUploadStates.remove(evidenceID);
+  else
+    liveUploadStates.insert(evidenceID, state);
+
+  auto row = rowForEvidenceID(evidenceID);
+  if (row >= 0) {
+    if (!finished) {
+      showUploadState(row, state, errorText);
+    }
+    else {
+      refreshRow(row);
+      if (state == model::UploadState::DONE && row == evidenceTable->currentRow())
+        Q_EMIT evidenceChanged(evidenceID, true);  // lock the editing form
+    }
   }
-  else {
-    this->editButton->setEnabled(!readonly);
-    this->editButton->setToolTip(readonly
-                                     ? tr("Edit is only available on unsubmitted evidence")
-                                     : tr("Update this data before submitting"));
+
+  // failed attempts are retried by the queue, so only report on uploads that are finished
+  if (!finished || !pendingSubmissions.remove(evidenceID))
+    return;
+  if (state == model::UploadState::FAILED) {
+    submissionFailures++;
+    lastSubmissionError = errorText;
   }
+  if (pendingSubmissions.isEmpty())
+    finishSubmissions();
+  else
+    showSubmissionProgress();
 }
 
-void EvidenceManager::onUploadComplete() {
-  bool isValid;
-  NetMan::extractResponse(uploadAssetReply, isValid);
-
-  if (!isValid) {
-    auto errMessage = tr("Unable to upload evidence: Network error (%1)").arg(uploadAssetReply->errorString());
-    db->updateEvidenceError(errMessage, evidenceIDForRequest);
-    QMessageBox::warning(this, tr("Cannot Submit Evidence"),
-                         tr("Upload failed: Network error. Check your connection and try again.\n"
-                         "(Error: %1)").arg(uploadAssetReply->errorString()));
-  } else {
-    db->updateEvidenceSubmitted(evidenceIDForRequest);
-    Q_EMIT evidenceChanged(evidenceIDForRequest, true);  // lock the editing form
+int EvidenceManager::rowForEvidenceID(qint64 evidenceID) {
+  for (int row = 0; row < evidenceTable->rowCount(); row++) {
+    auto rowItem = evidenceTable->item(row, 0);
+    if (rowItem != nullptr && rowItem->data(Qt::UserRole).toLongLong() == evidenceID)
+      return row;
   }
-  refreshRow(evidenceTable->currentRow());
-
-  // we don't actually need anything from the uploadAssets reply, so just clean it up.
-  // one thing we might want to record: evidence uuid... not sure why we'd need it though.
-  loadingAnimation->stopAnimation();
-  evidenceTable->setEnabled(true);
-
-  cleanUpReply(&uploadAssetReply);
+  return -1;
 }
 
 qint64 EvidenceManager::selectedRowEvidenceID() {
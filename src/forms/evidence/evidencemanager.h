@@ -3,16 +3,22 @@
 #include "ashirtdialog/ashirtdialog.h"
 
 #include <QAction>
+#include <QHash>
+#include <QLabel>
+#include <QSet>
 #include <QLineEdit>
 #include <QMenu>
-#include <QNetworkReply>
 #include <QTableWidget>
 #include <QTableWidgetItem>
+#include <memory>
 
 #include "components/evidence_editor/evidenceeditor.h"
 #include "components/loading/qprogressindicator.h"
 #include "db/databaseconnection.h"
+#include "db/evidencecursor.h"
+#include "forms/evidence/evidencedeletion.h"
 #include "forms/evidence_filter/evidencefilterform.h"
+#include "models/upload.h"
 
 //class
 /// EvidenceRow contains the necessary data for a full row in the evidence table.
@@ -51,24 +57,47 @@ class EvidenceManager : public AShirtDialog {
   /// openTableContextMenu opens a context menu over the evidenceTable when right-clicking
   void openTableContextMenu(QPoint pos);
 
-  /// saveData stores any edits in evidence view. Deprecated (edits no longer available)
-  bool saveData();
-  /// loadEvidence retrieves data from the database and renders the evidence table
+  /// saveData stores any edits in evidence view, warning the user if they could not be saved. The
+  /// future holds true once the edits are saved.
+  QFuture<bool> saveData();
+  /// loadEvidence retrieves data from the database and renders the evidence table. Rows are added
+  /// one page at a time (see loadEvidencePage)
   void loadEvidence();
+  /// loadEvidencePage requests the next page of evidence from the database worker. Once it arrives,
+  /// the page is added to the table, and the following page is requested, if any.
+  /// generation identifies the loadEvidence call this page belongs to.
+  void loadEvidencePage(quint64 generation);
+  /// appendEvidencePage adds the given evidence to the end of the table
+  void appendEvidencePage(const QList<model::Evidence>& page);
+  /// refreshStats updates statsLabel for the given operation (or the current operation, if empty)
+  void refreshStats(const QString& operationSlug);
   /// buildBaseEvidenceRow constructs a basic evidence row (fields and formatting, no data applied)
   EvidenceRow buildBaseEvidenceRow(qint64 evidenceID);
   /// refreshRow updates the indicated row (0-based) with updated (database) data.
   void refreshRow(int row);
   /// setRowText writes data the indicated row (0-based) based on the given model
   void setRowText(int row, const model::Evidence& model);
+  /// showUploadState shows the progress of an upload (that is not yet finished) on the indicated row
+  void showUploadState(int row, model::UploadState state, const QString& errorText);
 
   /// showEvent extends QDialog's showEvent. Resets the applied filters.
   void showEvent(QShowEvent* evt) override;
   /// selectedRowEvidenceID is a small helper to get the evidence id for the currently selected row.
   qint64 selectedRowEvidenceID();
+  /// rowForEvidenceID returns the row (0-based) showing the given evidence, or -1 if it is not shown
+  int rowForEvidenceID(qint64 evidenceID);
   /// selectedRowEvidenceIDs is a small helper to retrieve the id for all the selected rows
   QList<qint64> selectedRowEvidenceIDs();
 
+  /// deleteSet deletes the provided ids from the database (see EvidenceDeletion), and then
+  /// processes the result (see onEvidenceDeleted)
+  void deleteSet(QList<qint64> ids);
+  /// onEvidenceDeleted removes the deleted rows from the table, and then removes the evidence files
+  /// in the background, reporting progress in statsLabel
+  void onEvidenceDeleted(const EvidenceDeletion::Result& deleted);
+  /// reportUndeletedFiles logs, and tells the user about, evidence files that could not be removed
+  void reportUndeletedFiles(const QStringList& undeletedFiles);
+
  signals:
   /**
    * @brief evidenceChanged is emitted when a user changes the selection in the evidence table
@@ -78,8 +107,12 @@ class EvidenceManager : public AShirtDialog {
   void evidenceChanged(quint64 evidenceID, bool readonly);
 
  private slots:
-  /// submitEvidenceTriggered recieves the triggered event from the submit action
+  /// submitEvidenceTriggered recieves the triggered event from the submit action. All of the
+  /// selected, unsubmitted, evidence is submitted.
   void submitEvidenceTriggered();
+  /// submitAllTriggered recieves the triggered event from the submit all action. All of the
+  /// unsubmitted evidence matching the current filters is submitted (after confirmation).
+  void submitAllTriggered();
   /// deleteEvidenceTriggered recieves the triggered event from the delete action
   void deleteEvidenceTriggered();
   /// resetFilterButtonClicked recieves the reset filter button clicked event
@@ -94,10 +127,6 @@ class EvidenceManager : public AShirtDialog {
   /// cancelEditEvidenceButtonClicked resets the edit/cancel buttons
   void cancelEditEvidenceButtonClicked();
 
-  /// deleteSet is a small helper to iterate through the provided list, delete the ids, and process
-  /// the result
-  void deleteSet(QList<qint64> ids);
-
   /// applyFilterForm updates the filter textbox to reflect the filter options chosen in the filter
   /// menu
   void applyFilterForm(const EvidenceFilters& filter);
@@ -106,8 +135,15 @@ class EvidenceManager : public AShirtDialog {
 
   /// onRowChanged recieves the event from the evidence table rowChange signal
   void onRowChanged(int currentRow, int currentColumn, int previousRow, int previousColumn);
-  /// onUploadComplete is triggered when the upload response has been received.
-  void onUploadComplete();
+  /// submitSet queues the given evidence for upload (see UploadQueue), and tracks its progress
+  void submitSet(const QList<qint64>& ids);
+  /// showSubmissionProgress reports, in statsLabel, how many of the submitted evidence are done
+  void showSubmissionProgress();
+  /// finishSubmissions is called once all submitted evidence is done, and reports any failures
+  void finishSubmissions();
+  /// onUploadStateChanged refreshes the row for evidence moving through the UploadQueue, and
+  /// reports the outcome of uploads submitted from this window
+  void onUploadStateChanged(qint64 evidenceID, model::UploadState state, const QString& errorText);
 
   /// copyPathTriggered recives the triggered event from the copyPathToClipboardAction
   void copyPathTriggered();
@@ -116,14 +152,31 @@ class EvidenceManager : public AShirtDialog {
   /// db is a (shared) reference to the local database instance. Not to be deleted.
   DatabaseConnection* db;
 
-  QNetworkReply* uploadAssetReply = nullptr;
-  qint64 evidenceIDForRequest = 0;
+  /// evidenceCursor reads the evidence for the table; only set while a load is in progress.
+  /// Pages are read on the database worker, so the cursor is shared with the pending request.
+  std::shared_ptr<EvidenceCursor> evidenceCursor;
+  /// loadGeneration is incremented on each loadEvidence, so stale page loads can be dropped
+  quint64 loadGeneration = 0;
+  /// reselectID is the evidence that was selected before the table was (re)loaded
+  qint64 reselectID = -1;
+
+  /// pendingSubmissions is the evidence submitted from this window that has not yet been uploaded
+  /// (or failed to upload)
+  QSet<qint64> pendingSubmissions;
+  /// submissionTotal counts the evidence submitted since pendingSubmissions was last empty
+  int submissionTotal = 0;
+  /// submissionFailures counts the evidence (of submissionTotal) that failed to upload
+  int submissionFailures = 0;
+  QString lastSubmissionError;
+  /// liveUploadStates holds the state of evidence in the upload queue that has not yet finished
+  QHash<qint64, model::UploadState> liveUploadStates;
 
   // Subwindows
   EvidenceFilterForm* filterForm = nullptr;
   QMenu* evidenceTableContextMenu = nullptr;
 
   QAction* submitEvidenceAction = nullptr;
+  QAction* submitAllAction = nullptr;
   QAction* copyPathToClipboardAction = nullptr;
   QAction* deleteTableContentsAction = nullptr;
 
@@ -137,6 +190,8 @@ class EvidenceManager : public AShirtDialog {
   QTableWidget* evidenceTable = nullptr;
   EvidenceEditor* evidenceEditor = nullptr;
   QProgressIndicator* loadingAnimation = nullptr;
+  /// statsLabel summarizes the evidence counts for the operation being viewed
+  QLabel* statsLabel = nullptr;
   inline static const QStringList columnNames {
       QStringLiteral("Date Captured")
       , QStringLiteral("Operation")
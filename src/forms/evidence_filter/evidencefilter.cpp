@@ -22,6 +22,15 @@ QString EvidenceFilters::standardizeFilterKey(QString key) {
   if (FILTER_KEYS_CONTENT_TYPE.contains(key, Qt::CaseInsensitive)) {
     return FILTER_KEY_CONTENT_TYPE;
   }
+  if (FILTER_KEYS_TEXT.contains(key, Qt::CaseInsensitive)) {
+    return FILTER_KEY_TEXT;
+  }
+  if (FILTER_KEYS_TAG.contains(key, Qt::CaseInsensitive)) {
+    return FILTER_KEY_TAG;
+  }
+  if (FILTER_KEYS_NOT_TAG.contains(key, Qt::CaseInsensitive)) {
+    return FILTER_KEY_NOT_TAG;
+  }
   return key;
 }
 
@@ -71,6 +80,15 @@ QString EvidenceFilters::toString() const {
   if (submitted != Tri::Any) {
     rtn.append(appendTemp.arg(FILTER_KEY_SUBMITTED, triToText(submitted)));
   }
+  if (!text.isEmpty()) {
+    rtn.append(appendTemp.arg(FILTER_KEY_TEXT, text));
+  }
+  for (const auto& tagGroup : tags) {
+    rtn.append(appendTemp.arg(FILTER_KEY_TAG, tagGroup.join(FILTER_TAG_SEPARATOR)));
+  }
+  if (!excludedTags.isEmpty()) {
+    rtn.append(appendTemp.arg(FILTER_KEY_NOT_TAG, excludedTags.join(FILTER_TAG_SEPARATOR)));
+  }
 
   return rtn.trimmed();
 }
@@ -112,6 +130,17 @@ EvidenceFilters EvidenceFilters::parseFilter(const QString& text) {
     else if (key == FILTER_KEY_CONTENT_TYPE) {
       filter.contentType = value;
     }
+    else if (key == FILTER_KEY_TEXT) {
+      filter.text = value;
+    }
+    else if (key == FILTER_KEY_TAG) {
+      auto tagGroup = parseTagList(value);
+      if (!tagGroup.isEmpty())
+        filter.tags.append(tagGroup);
+    }
+    else if (key == FILTER_KEY_NOT_TAG) {
+      filter.excludedTags.append(parseTagList(value));
+    }
   }
 
   return filter;
@@ -132,6 +161,18 @@ Tri EvidenceFilters::parseTriFilterValue(const QString& text, bool strict) {
   return Tri::No;
 }
 
+// parseTagList splits a tag filter value (e.g. "web|db") into its individual tag names
+QStringList EvidenceFilters::parseTagList(const QString& text) {
+  QStringList rtn;
+  const auto names = text.split(FILTER_TAG_SEPARATOR, Qt::SkipEmptyParts);
+  for (const auto& name : names) {
+    auto trimmed = name.trimmed();
+    if (!trimmed.isEmpty())
+      rtn.append(trimmed);
+  }
+  return rtn;
+}
+
 QList<QPair<QString, QString>> EvidenceFilters::tokenizeFilterText(const QString& text) {
   QStringList list = text.split(QStringLiteral(":"), Qt::SkipEmptyParts);
   // now in: [Key][value key]...[value] format
@@ -196,3 +237,26 @@ QString EvidenceFilters::triToString(const Tri& tri) {
       return QT_TRANSLATE_NOOP("EvidenceFilter", "Any");
   }
 }
+
+// parseTagGroups splits text on FILTER_TAG_GROUP_SEPARATOR, and each group with parseTagList.
+// Empty groups are dropped.
+// This is the inverse of tagGroupsToString
+QList<QStringList> EvidenceFilters::parseTagGroups(const QString& text) {
+  QList<QStringList> rtn;
+  const auto groups = text.split(FILTER_TAG_GROUP_SEPARATOR, Qt::SkipEmptyParts);
+  for (const auto& group : groups) {
+    auto tagGroup = parseTagList(group);
+    if (!tagGroup.isEmpty())
+      rtn.append(tagGroup);
+  }
+  return rtn;
+}
+
+// tagGroupsToString returns the groups as e.g. "a|b, c"
+// This is the inverse of parseTagGroups
+QString EvidenceFilters::tagGroupsToString(const QList<QStringList>& groups) {
+  QStringList rtn;
+  for (const auto& group : groups)
+    rtn.append(group.join(FILTER_TAG_SEPARATOR));
+  return rtn.join(FILTER_TAG_GROUP_SEPARATOR + QStringLiteral(" "));
+}
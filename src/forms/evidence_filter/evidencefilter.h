@@ -20,15 +20,27 @@ class EvidenceFilters {
   Tri submitted = Tri::Any;
   QDate startDate = QDate();
   QDate endDate = QDate();
+  /// text limits results to evidence whose description or content contains all of the given words
+  QString text;
+  /// tags limits results to evidence carrying, for each group, at least one of the group's tags
+  /// (i.e. groups are ANDed together, while tags within a group are ORed)
+  QList<QStringList> tags;
+  /// excludedTags removes any evidence carrying any of these tags
+  QStringList excludedTags;
 
  public:
   static Tri parseTri(const QString &text);
   static QString triToString(const Tri &tri);
+  /// parseTagGroups reads tag groups written as "a|b, c" (i.e. groups are separated by commas, and
+  /// alternatives within a group by "|"). This is the inverse of tagGroupsToString
+  static QList<QStringList> parseTagGroups(const QString &text);
+  static QString tagGroupsToString(const QList<QStringList> &groups);
 
  private:
   static QList<QPair<QString, QString>> tokenizeFilterText(const QString &text);
   static QDate parseDateString(QString text);
   static Tri parseTriFilterValue(const QString &text, bool strict = false);
+  static QStringList parseTagList(const QString &text);
 
   // These represent the standard key for a filter
   inline static const QString FILTER_KEY_ERROR = QStringLiteral("err");
@@ -38,6 +50,13 @@ class EvidenceFilters {
   inline static const QString FILTER_KEY_ON = QStringLiteral("on");
   inline static const QString FILTER_KEY_OPERATION = QStringLiteral("op");
   inline static const QString FILTER_KEY_CONTENT_TYPE = QStringLiteral("type");
+  inline static const QString FILTER_KEY_TEXT = QStringLiteral("text");
+  inline static const QString FILTER_KEY_TAG = QStringLiteral("tag");
+  inline static const QString FILTER_KEY_NOT_TAG = QStringLiteral("-tag");
+  /// FILTER_TAG_SEPARATOR separates alternative tags within a single tag filter (e.g. tag: a|b)
+  inline static const QString FILTER_TAG_SEPARATOR = QStringLiteral("|");
+  /// FILTER_TAG_GROUP_SEPARATOR separates tag groups, when edited outside of a filter string
+  inline static const QString FILTER_TAG_GROUP_SEPARATOR = QStringLiteral(",");
 
   // These represent aliases for standard key for a filter
   inline static const QStringList FILTER_KEYS_ERROR = {
@@ -53,4 +72,7 @@ class EvidenceFilters {
   inline static const QStringList FILTER_KEYS_ON = {FILTER_KEY_ON};
   inline static const QStringList FILTER_KEYS_OPERATION = {FILTER_KEY_OPERATION, QStringLiteral("operation")};
   inline static const QStringList FILTER_KEYS_CONTENT_TYPE = {FILTER_KEY_CONTENT_TYPE, QStringLiteral("contentType")};
+  inline static const QStringList FILTER_KEYS_TEXT = {FILTER_KEY_TEXT, QStringLiteral("contains")};
+  inline static const QStringList FILTER_KEYS_TAG = {FILTER_KEY_TAG, QStringLiteral("tags")};
+  inline static const QStringList FILTER_KEYS_NOT_TAG = {FILTER_KEY_NOT_TAG, QStringLiteral("-tags")};
 };
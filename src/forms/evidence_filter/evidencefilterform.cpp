@@ -6,6 +6,7 @@
 #include <QDialogButtonBox>
 #include <QGridLayout>
 #include <QLabel>
+#include <QLineEdit>
 
 #include "appconfig.h"
 #include "helpers/netman.h"
@@ -41,6 +42,9 @@ EvidenceFilterForm::EvidenceFilterForm(QWidget *parent)
     , submittedComboBox(new QComboBox(this))
     , erroredComboBox(new QComboBox(this))
     , contentTypeComboBox(new QComboBox(this))
+    , textLineEdit(new QLineEdit(this))
+    , tagsLineEdit(new QLineEdit(this))
+    , excludedTagsLineEdit(new QLineEdit(this))
     , fromDateEdit(new QDateEdit(this))
     , toDateEdit(new QDateEdit(this))
     , includeStartDateCheckBox(new QCheckBox(tr("From Date"), this))
@@ -69,6 +73,13 @@ void EvidenceFilterForm::buildUi() {
   initializeDateEdit(fromDateEdit);
   initializeDateEdit(toDateEdit);
 
+  textLineEdit->setPlaceholderText(tr("Words in the description or content"));
+  tagsLineEdit->setPlaceholderText(tr("e.g. web|db, confirmed"));
+  tagsLineEdit->setToolTip(tr("Evidence must carry a tag from each comma separated group. "
+                              "Tags within a group are separated by |"));
+  excludedTagsLineEdit->setPlaceholderText(tr("e.g. draft|duplicate"));
+  excludedTagsLineEdit->setToolTip(tr("Evidence carrying any of these tags is left out"));
+
   // Layout
   /*        0                 1           2
        +---------------+-------------+--------------+
@@ -84,7 +95,13 @@ void EvidenceFilterForm::buildUi() {
        +---------------+-------------+--------------+
     5  | To Lbl        | To DtSel    | incl To CB   |
        +---------------+-------------+--------------+
-    6  | Dialog button Box{ok}                      |
+    6  | Text Lbl      | Text TB                    |
+       +---------------+-------------+--------------+
+    7  | Tags Lbl      | Tags TB                    |
+       +---------------+-------------+--------------+
+    8  | No Tags Lbl   | Excluded Tags TB           |
+       +---------------+-------------+--------------+
+    9  | Dialog button Box{ok}                      |
        +---------------+-------------+--------------+
   */
 
@@ -107,11 +124,20 @@ void EvidenceFilterForm::buildUi() {
   gridLayout->addWidget(includeEndDateCheckBox, 5, 0, Qt::AlignLeft);
   gridLayout->addWidget(toDateEdit, 5, 1, 1, 2);
 
-  gridLayout->addWidget(buttonBox, 6, 0, 1, gridLayout->columnCount());
+  gridLayout->addWidget(new QLabel(tr("Contains Text"), this), 6, 0);
+  gridLayout->addWidget(textLineEdit, 6, 1, 1, 2);
+
+  gridLayout->addWidget(new QLabel(tr("Has Tags"), this), 7, 0);
+  gridLayout->addWidget(tagsLineEdit, 7, 1, 1, 2);
+
+  gridLayout->addWidget(new QLabel(tr("Without Tags"), this), 8, 0);
+  gridLayout->addWidget(excludedTagsLineEdit, 8, 1, 1, 2);
+
+  gridLayout->addWidget(buttonBox, 9, 0, 1, gridLayout->columnCount());
 
   setLayout(gridLayout);
   setWindowTitle(tr("Evidence Filters"));
-  resize(320, 245);
+  resize(320, 335);
 }
 
 void EvidenceFilterForm::wireUi() {
@@ -148,6 +174,11 @@ EvidenceFilters EvidenceFilterForm::encodeForm() {
   filter.submitted = EvidenceFilters::parseTri(submittedComboBox->currentText());
   filter.operationSlug = operationComboBox->currentData().toString();
   filter.contentType = contentTypeComboBox->currentData().toString();
+  filter.text = textLineEdit->text().trimmed();
+  filter.tags = EvidenceFilters::parseTagGroups(tagsLineEdit->text());
+  // excluded tags are a single group, but accept either separator
+  for (const auto &group : EvidenceFilters::parseTagGroups(excludedTagsLineEdit->text()))
+    filter.excludedTags.append(group);
 
   dateNormalize(fromDateEdit->isEnabled() && toDateEdit->isEnabled());
 
@@ -166,6 +197,9 @@ void EvidenceFilterForm::setForm(const EvidenceFilters &model) {
   UIHelpers::setComboBoxValue(contentTypeComboBox, model.contentType);
   erroredComboBox->setCurrentText(EvidenceFilters::triToString(model.hasError));
   submittedComboBox->setCurrentText(EvidenceFilters::triToString(model.submitted));
+  textLineEdit->setText(model.text);
+  tagsLineEdit->setText(EvidenceFilters::tagGroupsToString(model.tags));
+  excludedTagsLineEdit->setText(EvidenceFilters::tagGroupsToString({model.excludedTags}));
 
   includeStartDateCheckBox->setChecked(model.startDate.isValid());
   fromDateEdit->setDate(model.startDate.isValid() ? model.startDate
@@ -7,6 +7,7 @@
 
 class QComboBox;
 class QLabel;
+class QLineEdit;
 class QDateEdit;
 class QCheckBox;
 class QDialogButtonBox;
@@ -49,6 +50,9 @@ class EvidenceFilterForm : public AShirtDialog {
   QComboBox* submittedComboBox = nullptr;
   QComboBox* erroredComboBox = nullptr;
   QComboBox* contentTypeComboBox = nullptr;
+  QLineEdit* textLineEdit = nullptr;
+  QLineEdit* tagsLineEdit = nullptr;
+  QLineEdit* excludedTagsLineEdit = nullptr;
   QDateEdit* fromDateEdit = nullptr;
   QDateEdit* toDateEdit = nullptr;
   QCheckBox* includeEndDateCheckBox = nullptr;
@@ -6,8 +6,8 @@
 #include "components/evidence_editor/evidenceeditor.h"
 #include "components/loading_button/loadingbutton.h"
 #include "db/databaseconnection.h"
-#include "helpers/netman.h"
-#include "helpers/cleanupreply.h"
+#include "forms/evidence/evidencedeletion.h"
+#include "uploadqueue.h"
 
 GetInfo::GetInfo(DatabaseConnection* db, qint64 evidenceID, QWidget* parent)
     : AShirtDialog(parent, AShirtDialog::commonWindowFlags)
@@ -22,7 +22,6 @@ GetInfo::GetInfo(DatabaseConnection* db, qint64 evidenceID, QWidget* parent)
 
 GetInfo::~GetInfo() {
   delete evidenceEditor;
-  cleanUpReply(&uploadAssetReply);
 }
 
 void GetInfo::buildUi() {
@@ -62,6 +61,8 @@ void GetInfo::buildUi() {
 }
 
 void GetInfo::wireUi() {
+  connect(UploadQueue::get(), &UploadQueue::uploadStateChanged, this, &GetInfo::onUploadStateChanged);
+  connect(UploadQueue::get(), &UploadQueue::evidenceSubmitted, this, &GetInfo::onEvidenceSubmitted);
 }
 
 void GetInfo::showEvent(QShowEvent* evt) {
@@ -70,82 +71,101 @@ void GetInfo::showEvent(QShowEvent* evt) {
                // closing the window
 }
 
-bool GetInfo::saveData() {
-  auto saveResponse = evidenceEditor->saveEvidence();
-  if (!saveResponse.actionSucceeded) {
-    QMessageBox::warning(this, tr("Cannot Save"),
-                         tr("Unable to save evidence data.\n"
-                         "You can try uploading directly to the website. File Location:\n%1")
-                           .arg(saveResponse.model.path));
-  }
-  return saveResponse.actionSucceeded;
+QFuture<bool> GetInfo::saveData() {
+  return evidenceEditor->saveEvidence().then(this, [this](const SaveEvidenceResponse& saveResponse) {
+    if (!saveResponse.actionSucceeded) {
+      QMessageBox::warning(this, tr("Cannot Save"),
+                           tr("Unable to save evidence data.\n"
+                           "You can try uploading directly to the website. File Location:\n%1")
+                             .arg(saveResponse.model.path));
+    }
+    return saveResponse.actionSucceeded;
+  });
 }
 
 void GetInfo::submitButtonClicked()
 {
     submitButton->startAnimation();
     Q_EMIT setActionButtonsEnabled(false);
-    if (!saveData())
-        return;
-    model::Evidence evi = db->getEvidenceDetails(evidenceID);
-    if(evi.id == -1) {
-        QMessageBox::warning(this, tr("Cannot submit evidence"),
-                             tr("Could not retrieve data. Please try again."));
-        return;
-    }
-    uploadAssetReply = NetMan::uploadAsset(evi);
-    connect(uploadAssetReply, &QNetworkReply::finished, this, &GetInfo::onUploadComplete);
+    saveData().then(this, [this](bool saved) {
+        if (!saved) {
+            submitButton->stopAnimation();
+            Q_EMIT setActionButtonsEnabled(true);
+            return;
+        }
+        // evidence that no longer exists is skipped by the queue (and reported below)
+        awaitingUpload = true;
+        UploadQueue::get()->enqueue({evidenceID}).then(this, [this](const QList<qint64>& queued) {
+            if (!queued.isEmpty() || !awaitingUpload)
+                return;
+            // skipped: the evidence has already been submitted, or is being uploaded (in which case
+            // evidenceSubmitted still closes this window)
+            awaitingUpload = false;
+            submitButton->stopAnimation();
+            Q_EMIT setActionButtonsEnabled(true);
+            QMessageBox::information(this, tr("Submit Evidence"),
+                                     tr("This evidence has already been submitted, or is being uploaded."));
+        });
+    });
 }
 
 void GetInfo::deleteButtonClicked() {
   auto reply = QMessageBox::question(this, tr("Discard Evidence"),
                                      tr("Are you sure you want to discard this evidence?"),
                                      QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+  if (reply != QMessageBox::Yes)
+    return;
 
-  if (reply == QMessageBox::Yes) {
-    Q_EMIT  setActionButtonsEnabled(false);
-    bool shouldClose = true;
-
-    model::Evidence evi = evidenceEditor->encodeEvidence();
-    if (!QFile::remove(evi.path)) {
+  Q_EMIT setActionButtonsEnabled(false);
+  EvidenceDeletion::deleteEvidence({evidenceID}).then(this, [this](const EvidenceDeletion::Result& deleted) {
+    if (!deleted.success) {
       QMessageBox::warning(this, tr("Could not delete"),
-                           tr("Unable to delete evidence file.\n"
-                           "You can try deleting the file directly. File Location:\n%1")
-                             .arg(evi.path));
-      shouldClose = false;
+                           tr("Unable to delete evidence: %1").arg(deleted.errorText));
+      Q_EMIT setActionButtonsEnabled(true);
+      return;
     }
+    // content-addressed files may be shared with other evidence, in which case nothing is removed
+    EvidenceDeletion::removeFiles(deleted.unusedPaths).then(this, [this](const QFuture<QString>& removal) {
+      const auto undeletedFiles = removal.results();
+      Q_EMIT setActionButtonsEnabled(true);
+      if (!undeletedFiles.isEmpty()) {
+        QMessageBox::warning(this, tr("Could not delete"),
+                             tr("Unable to delete evidence file.\n"
+                             "You can try deleting the file directly. File Location:\n%1")
+                               .arg(undeletedFiles.first()));
+        return;
+      }
+      close();
+    });
+  });
+}
 
-    db->deleteEvidence(evidenceID);
+void GetInfo::onUploadStateChanged(qint64 id, model::UploadState state, const QString& errorText)
+{
+    if (id != evidenceID || !awaitingUpload || errorText.isEmpty())
+        return;
 
+    awaitingUpload = false;
+    const auto retryNote = state == model::UploadState::QUEUED
+        ? tr("This evidence has been saved, and will be uploaded again automatically. "
+             "You can close this window.")
+        : tr("This evidence has been saved. You can close this window and re-submit from the "
+             "evidence manager.");
+    QMessageBox::warning(this, tr("Cannot submit evidence"),
+                         tr("Upload failed. Check your connection and try again.\n"
+                            "Note: %1"
+                            "\n(Error: %2)").arg(retryNote, errorText));
+    submitButton->stopAnimation();
     Q_EMIT setActionButtonsEnabled(true);
-    if (shouldClose) {
-      close();
-    }
-  }
 }
 
-void GetInfo::onUploadComplete()
+void GetInfo::onEvidenceSubmitted(const model::Evidence& evi)
 {
-    if (uploadAssetReply->error() != QNetworkReply::NoError) {
-        auto errMessage = tr("Unable to upload evidence: Network error (%1)").arg(uploadAssetReply->errorString());
-        db->updateEvidenceError(errMessage, evidenceID);
-        if(!db->errorString().isEmpty())
-            qWarning() << "Upload failed. Could not update internal database. Error: " << db->errorString();
-        QMessageBox::warning(this, tr("Cannot submit evidence"),
-                             tr("Upload failed: Network error. Check your connection and try again.\n"
-                                "Note: This evidence has been saved. You can close this window and "
-                                "re-submit from the evidence manager."
-                                "\n(Error: %1)").arg(uploadAssetReply->errorString()));
-    } else {
-        db->updateEvidenceSubmitted(evidenceID);
-        if(!db->errorString().isEmpty())
-            qWarning() << "Upload successful. Could not update internal database. Error: " << db->errorString();
-        Q_EMIT evidenceSubmitted(db->getEvidenceDetails(evidenceID));
-        close();
-    }
-    // we don't actually need anything from the uploadAssets reply, so just clean it up.
-    // one thing we might want to record: evidence uuid... not sure why we'd need it though.
+    if (evi.id != evidenceID)
+        return;
+    awaitingUpload = false;
     submitButton->stopAnimation();
     Q_EMIT setActionButtonsEnabled(true);
-    cleanUpReply(&uploadAssetReply);
+    Q_EMIT evidenceSubmitted(evi);
+    close();
 }
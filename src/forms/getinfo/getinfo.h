@@ -2,8 +2,8 @@
 
 #include "ashirtdialog/ashirtdialog.h"
 
-#include <QNetworkReply>
 #include "components/evidence_editor/evidenceeditor.h"
+#include "models/upload.h"
 
 class DatabaseConnection;
 class LoadingButton;
@@ -18,7 +18,9 @@ class GetInfo : public AShirtDialog {
  private:
   void buildUi();
   void wireUi();
-  bool saveData();
+  /// saveData saves the editor changes, warning the user if they could not be saved. The future
+  /// holds true once the changes are saved.
+  QFuture<bool> saveData();
   void showEvent(QShowEvent *evt) override;
 
  signals:
@@ -26,7 +28,10 @@ class GetInfo : public AShirtDialog {
  private slots:
   void submitButtonClicked();
   void deleteButtonClicked();
-  void onUploadComplete();
+  /// onUploadStateChanged reports a failed upload of this evidence (see UploadQueue)
+  void onUploadStateChanged(qint64 id, model::UploadState state, const QString& errorText);
+  /// onEvidenceSubmitted closes the window once this evidence has been uploaded
+  void onEvidenceSubmitted(const model::Evidence& evi);
 
  public:
  signals:
@@ -35,7 +40,8 @@ class GetInfo : public AShirtDialog {
  private:
   DatabaseConnection *db;
   qint64 evidenceID;
-  QNetworkReply *uploadAssetReply = nullptr;
+  /// awaitingUpload is true while this window is waiting on an upload it submitted
+  bool awaitingUpload = false;
 
   // Ui Components
   EvidenceEditor *evidenceEditor = nullptr;
@@ -12,6 +12,7 @@
 #include <QtConcurrent/QtConcurrent>
 
 #include "db/databaseconnection.h"
+#include "db/databaseconnectionpool.h"
 
 PortingDialog::PortingDialog(PortType dialogType, DatabaseConnection* db, QWidget *parent)
   : AShirtDialog(parent)
@@ -161,19 +162,15 @@ void PortingDialog::doExport(porting::SystemManifest* manifest, const QString& e
     options.exportDb = portEvidenceCheckBox->isChecked();
     options.exportConfig = portConfigCheckBox->isChecked();
     
-    // Qt db access is limited to single-thread access. A new connection needs to be made, hence
-    // the withconnection here that connects to the same database. Note: we shouldn't write to the db
-    // in this thread, if possible.
-    QString threadedDbName = QStringLiteral("%1_mt_forExport").arg(Constants::defaultDbName);
-    auto success = DatabaseConnection::withConnection(
-                db->getDatabasePath(), threadedDbName, [this, &manifest, exportPath, options](DatabaseConnection conn) {
-                                          manifest->exportManifest(&conn, exportPath, options);
-    });
-    if(success) {
+    // Qt db access is limited to single-thread access, so this (worker) thread needs its own
+    // connection to the same database.
+    auto conn = DatabaseConnectionPool::get()->connectionForCurrentThread();
+    if(conn) {
+        manifest->exportManifest(conn, exportPath, options);
         Q_EMIT onWorkComplete(true);
         return;
     }
-    portStatusLabel->setText(tr("Error during export: %1").arg(db->errorString()));
+    portStatusLabel->setText(tr("Error during export: %1").arg(DatabaseConnectionPool::get()->lastError()));
     Q_EMIT onWorkComplete(false);
 }
 
@@ -192,15 +189,12 @@ void PortingDialog::doImport(porting::SystemManifest* manifest)
     porting::SystemManifestImportOptions options;
     options.importDb = portEvidenceCheckBox->isChecked() ? options.Merge : options.None;
     options.importConfig = portConfigCheckBox->isChecked();
-    QString threadedDbName = QStringLiteral("%1_mt_forImport").arg(Constants::defaultDbName);
-    auto success = DatabaseConnection::withConnection(
-                db->getDatabasePath(), threadedDbName, [this, &manifest, options](DatabaseConnection conn){
-        manifest->applyManifest(options, &conn);
-    });
-    if(success) {
+    auto conn = DatabaseConnectionPool::get()->connectionForCurrentThread();
+    if(conn) {
+        manifest->applyManifest(options, conn);
         Q_EMIT onWorkComplete(true);
         return;
     }
-    portStatusLabel->setText(tr("Error during import: %1").arg(db->errorString()));
+    portStatusLabel->setText(tr("Error during import: %1").arg(DatabaseConnectionPool::get()->lastError()));
     Q_EMIT onWorkComplete(false);
 }
@@ -34,6 +34,7 @@ Settings::Settings(QWidget *parent)
     , testConnectionButton(new LoadingButton(tr("Test Connection"), this))
     , couldNotSaveSettingsMsg(new QErrorMessage(this))
     , showWelcomeScreen(new QCheckBox(tr("Show Welcome Screen"), this))
+    , shareIdenticalEvidence(new QCheckBox(tr("Store Identical Screenshots Once"), this))
 {
   buildUi();
   wireUi();
@@ -63,7 +64,7 @@ void Settings::buildUi() {
        +---------------+-------------+------------+-------------+
     6  | CodeblkSh Lbl | [CodeblkSh TB]                         |
        +---------------+-------------+------------+-------------+
-    7  |                               [] Show Welcome Screen   |
+    7  |               | [] Show Welcome Screen | [] Store Once |
        +---------------+-------------+------------+-------------+
     8  | Test Conn Btn |  StatusLabel                           |
        +---------------+-------------+------------+-------------+
@@ -107,7 +108,9 @@ void Settings::buildUi() {
   gridLayout->addWidget(captureClipboardShortcutTextBox, 6, 1);
 
   // row 7
-  gridLayout->addWidget(showWelcomeScreen, 7, 1, 1, 5);
+  gridLayout->addWidget(showWelcomeScreen, 7, 1, 1, 2);
+  shareIdenticalEvidence->setToolTip(tr("Screenshots with identical content share a single file in the evidence repository"));
+  gridLayout->addWidget(shareIdenticalEvidence, 7, 3, 1, 2);
 
   // row 8
   gridLayout->addWidget(testConnectionButton, 8, 0);
@@ -179,6 +182,7 @@ void Settings::showEvent(QShowEvent *evt) {
   captureWindowShortcutTextBox->setKeySequence(QKeySequence::fromString(AppConfig::value(CONFIG::SHORTCUT_CAPTUREWINDOW)));
   captureClipboardShortcutTextBox->setKeySequence(QKeySequence::fromString(AppConfig::value(CONFIG::SHORTCUT_CAPTURECLIPBOARD)));
   showWelcomeScreen->setChecked(AppConfig::value(CONFIG::SHOW_WELCOME_SCREEN) == "true");
+  shareIdenticalEvidence->setChecked(AppConfig::value(CONFIG::SHARE_IDENTICAL_EVIDENCE) == "true");
 
   // re-enable form
   connStatusLabel->clear();
@@ -215,6 +219,7 @@ void Settings::onSaveClicked() {
   AppConfig::setValue(CONFIG::SHORTCUT_CAPTURECLIPBOARD, captureClipboardShortcutTextBox->keySequence().toString());
   QString showWelcome = showWelcomeScreen->isChecked() ? "true" : "false";
   AppConfig::setValue(CONFIG::SHOW_WELCOME_SCREEN, showWelcome);
+  AppConfig::setValue(CONFIG::SHARE_IDENTICAL_EVIDENCE, shareIdenticalEvidence->isChecked() ? "true" : "false");
 
   HotkeyManager::updateHotkeys();
   close();
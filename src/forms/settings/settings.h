@@ -75,4 +75,5 @@ class Settings : public AShirtDialog {
   QPushButton* eviRepoBrowseButton = nullptr;
   QErrorMessage* couldNotSaveSettingsMsg = nullptr;
   QCheckBox *showWelcomeScreen = nullptr;
+  QCheckBox *shareIdenticalEvidence = nullptr;
 };
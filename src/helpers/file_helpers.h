@@ -1,8 +1,13 @@
 #pragma once
 
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFileInfo>
+#include <QFuture>
+#include <QPromise>
 #include <QRandomGenerator>
+#include <QThreadPool>
+#include <memory>
 
 class FileHelpers {
  public:
@@ -36,4 +41,52 @@ class FileHelpers {
 
   /// getDirname is a small helper to convert a filepath to a file into a path to the file's parent
   static QString getDirname(QString filepath) { return QFileInfo(filepath).dir().path(); }
+
+  /// sha256 returns the hex-encoded SHA-256 of the file at path, or an empty string if the file
+  /// cannot be read. The file is streamed, rather than read into memory all at once.
+  static QString sha256(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+      return QString();
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file))
+      return QString();
+    return QString::fromLatin1(hash.result().toHex());
+  }
+
+  /// sha256Async is sha256, run on the global thread pool, so that hashing a large file never holds
+  /// up the calling thread (or the database worker)
+  static QFuture<QString> sha256Async(const QString &path) {
+    auto promise = std::make_shared<QPromise<QString>>();
+    auto future = promise->future();
+    promise->start();
+    QThreadPool::globalInstance()->start([promise, path] {
+      promise->addResult(sha256(path));
+      promise->finish();
+    });
+    return future;
+  }
+
+  /**
+   * @brief moveToContentStore moves the file at path into a content-addressed store, where it is
+   * named after its hash (<storeRoot>/<first 2 hash chars>/<hash>.<extension>). If the store
+   * already holds identical content, the file at path is removed instead.
+   * @param path The file to store
+   * @param storeRoot The root directory of the store
+   * @param hash The file's hash (see sha256)
+   * @return the file's new path, or path itself if the file could not be stored
+   */
+  static QString moveToContentStore(const QString &path, const QString &storeRoot,
+                                    const QString &hash) {
+    if (hash.size() < 2)
+      return path;
+    auto storedPath = QStringLiteral("%1/%2/%3.%4")
+                          .arg(storeRoot, hash.left(2), hash, QFileInfo(path).suffix());
+    if (QFile::exists(storedPath)) {
+      QFile::remove(path);
+      return storedPath;
+    }
+    QDir().mkpath(getDirname(storedPath));
+    return QFile::rename(path, storedPath) ? storedPath : path;
+  }
 };
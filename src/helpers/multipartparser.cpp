@@ -8,39 +8,124 @@
 
 #include "multipartparser.h"
 
+#include <QDebug>
 #include <QFileInfo>
+#include <algorithm>
 
 #include "string_helpers.h"
 
+void MultipartStream::appendData(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return;
+    // consecutive buffers are merged, so that reads cross fewer segments
+    if (!m_segments.empty() && !m_segments.back().file) {
+        m_segments.back().data.append(data);
+        m_segments.back().length += data.size();
+    } else {
+        Segment segment;
+        segment.start = m_size;
+        segment.length = data.size();
+        segment.data = data;
+        m_segments.push_back(std::move(segment));
+    }
+    m_size += data.size();
+}
+
+bool MultipartStream::appendFile(const QString &path)
+{
+    auto file = std::make_unique<QFile>(path);
+    if (!file->open(QIODevice::ReadOnly))
+        return false;
+    Segment segment;
+    segment.start = m_size;
+    segment.length = file->size();
+    segment.file = std::move(file);
+    m_size += segment.length;
+    m_segments.push_back(std::move(segment));
+    return true;
+}
+
+bool MultipartStream::seek(qint64 pos)
+{
+    if (pos < 0 || pos > m_size)
+        return false;
+    m_offset = pos;
+    return QIODevice::seek(pos);
+}
+
+qint64 MultipartStream::readData(char *data, qint64 maxSize)
+{
+    // QIODevice expects 0 at the end of the data; -1 is only for errors
+    if (m_offset >= m_size)
+        return 0;
+
+    // find the segment holding m_offset; segments are ordered by start
+    auto segment = std::upper_bound(m_segments.begin(), m_segments.end(), m_offset,
+                                    [](qint64 offset, const Segment &s) { return offset < s.start; });
+    --segment;
+
+    qint64 copied = 0;
+    for (; segment != m_segments.end() && copied < maxSize; ++segment) {
+        if (segment->length == 0)
+            continue;
+        qint64 segmentOffset = m_offset - segment->start;
+        qint64 toCopy = std::min(maxSize - copied, segment->length - segmentOffset);
+        if (segment->file) {
+            // the file was opened when the stream was built, so it shrinking (or failing) is an error
+            qint64 read = segment->file->seek(segmentOffset)
+                              ? segment->file->read(data + copied, toCopy)
+                              : -1;
+            if (read <= 0) {
+                setErrorString(tr("Unable to read %1: %2")
+                                   .arg(segment->file->fileName(), segment->file->errorString()));
+                return copied > 0 ? copied : -1;
+            }
+            toCopy = read;
+        } else {
+            std::copy_n(segment->data.constData() + segmentOffset, toCopy, data + copied);
+        }
+        copied += toCopy;
+        m_offset += toCopy;
+        if (segmentOffset + toCopy < segment->length)
+            break;  // a short file read; the rest is read on the next call
+    }
+    return copied;
+}
+
 MultipartParser::MultipartParser()
     : m_boundary(QStringLiteral("----ASHIRTTrayApp%1").arg(StringHelpers::randomString(16)))
 { }
 
-const QByteArray &MultipartParser::generateBody()
+QString MultipartParser::contentTypeFor(const QString &path)
+{
+    QString ext = QFileInfo(path).completeSuffix().toLower();
+    if(ext.endsWith(QStringLiteral("jpg")) || ext.endsWith(QStringLiteral("jpeg")))
+        return QStringLiteral("image/jpeg");
+    if(ext.endsWith(QStringLiteral("txt")) || ext.endsWith(QStringLiteral("log")))
+        return QStringLiteral("text/plain");
+    return QStringLiteral("application/octet-stream");
+}
+
+MultipartStream *MultipartParser::generateStream(QObject *parent)
 {
-    m_body.clear();
+    auto stream = new MultipartStream(parent);
     for (const auto &param : m_paramList) {
-        m_body.append(m_contentHeader.arg(m_boundary).toUtf8());
-        m_body.append(m_contentParam.arg(param.first).toUtf8());
-        m_body.append(param.second.toUtf8());
+        stream->appendData(m_contentHeader.arg(m_boundary).toUtf8());
+        stream->appendData(m_contentParam.arg(param.first).toUtf8());
+        stream->appendData(param.second.toUtf8());
     }
     for (const auto &pair : m_fileList) {
-        QFileInfo info = QFileInfo(pair.second);
-        QString name = info.fileName();
-        QString ext = info.completeSuffix().toLower();
-        QString type = QStringLiteral("application/octet-stream");
-        QByteArray data;
-        QFile file(pair.second);
-        if (file.open(QIODevice::ReadOnly))
-            data = file.readAll();
-        if(ext.endsWith(QStringLiteral("jpg")) || ext.endsWith(QStringLiteral("jpeg")))
-            type = QStringLiteral("image/jpeg");
-        else if(ext.endsWith(QStringLiteral("txt")) || ext.endsWith(QStringLiteral("log")))
-            type = QStringLiteral("text/plain");
-        m_body.append(m_contentHeader.arg(m_boundary).toUtf8());
-        m_body.append(m_contentFile.arg(pair.first, name, type).toUtf8());
-        m_body.append(data);
+        stream->appendData(m_contentHeader.arg(m_boundary).toUtf8());
+        stream->appendData(m_contentFile.arg(pair.first, QFileInfo(pair.second).fileName(),
+                                             contentTypeFor(pair.second)).toUtf8());
+        if (!stream->appendFile(pair.second)) {
+            qWarning() << "Unable to open file for upload: " << pair.second;
+            delete stream;
+            return nullptr;
+        }
     }
-    m_body.append(QStringLiteral("\r\n--%1--\r\n").arg(m_boundary).toUtf8());
-    return m_body;
+    stream->appendData(QStringLiteral("\r\n--%1--\r\n").arg(m_boundary).toUtf8());
+    stream->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    return stream;
 }
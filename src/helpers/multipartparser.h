@@ -8,9 +8,50 @@
 
 #pragma once
 
+#include <QFile>
+#include <QIODevice>
 #include <QList>
 #include <QPair>
 #include <QString>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The MultipartStream class is a read-only, random access device over a multipart body.
+ * The body is a sequence of segments: small in-memory buffers (boundaries and part headers) and
+ * files, which are read from disk as the body is read. The body is never held in memory as a whole,
+ * so memory use does not depend on the size of the files.
+ */
+class MultipartStream : public QIODevice {
+  Q_OBJECT
+ public:
+  explicit MultipartStream(QObject *parent = nullptr) : QIODevice(parent) { }
+
+  /// appendData adds an in-memory segment. Only valid before the stream is opened.
+  void appendData(const QByteArray &data);
+  /// appendFile adds a file segment. Only valid before the stream is opened.
+  /// Returns false if the file cannot be opened.
+  bool appendFile(const QString &path);
+
+  bool isSequential() const override { return false; }
+  qint64 size() const override { return m_size; }
+  bool seek(qint64 pos) override;
+
+ protected:
+  qint64 readData(char *data, qint64 maxSize) override;
+  qint64 writeData(const char *, qint64) override { return -1; }
+
+ private:
+  struct Segment {
+    qint64 start = 0;
+    qint64 length = 0;
+    QByteArray data;
+    std::unique_ptr<QFile> file;
+  };
+  std::vector<Segment> m_segments;
+  qint64 m_size = 0;
+  qint64 m_offset = 0;
+};
 
 class MultipartParser {
  public:
@@ -22,13 +63,17 @@ class MultipartParser {
   inline void addFile(const QString &name = QString(), const QString &value = QString()) {
       m_fileList.append(QPair<QString, QString>(name, value));
   }
-  const QByteArray &generateBody();
+  /// generateStream builds the body as an (opened) MultipartStream. Files are streamed from disk,
+  /// rather than read into memory. Returns nullptr if any of the files cannot be opened.
+  MultipartStream *generateStream(QObject *parent = nullptr);
  private:
+  /// contentTypeFor guesses the mime type of the file at path, from its extension
+  static QString contentTypeFor(const QString &path);
+
   inline static const auto m_contentHeader = QStringLiteral("\r\n--%1\r\n");
   inline static const auto m_contentParam = QStringLiteral("Content-Disposition: form-data; name=\"%1\"\r\n\r\n");
   inline static const auto m_contentFile = QStringLiteral("Content-Disposition: form-data; name=\"%1\"; filename=\"%2\"\r\nContent-Type: %3\r\n\r\n");
   QString m_boundary;
-  QByteArray m_body;
   QList<QPair<QString, QString>> m_paramList;
   QList<QPair<QString, QString>> m_fileList;
 };
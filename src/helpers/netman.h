@@ -1,9 +1,24 @@
 #pragma once
 
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
 #include <QMessageAuthenticationCode>
 #include <QNetworkAccessManager>
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
+#include <QPromise>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QUrl>
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#endif
 #include <algorithm>
+#include <memory>
+#include <optional>
 
 #include "appconfig.h"
 #include "request_builder.h"
@@ -33,11 +48,24 @@ public:
     return &i;
   }
 
-  /// uploadAsset takes the given Evidence model, encodes it (and the file), and uploads this
-  /// to the configured ASHIRT API server. Returns a QNetworkReply to track the request
+  /// PreparedUpload is an evidence upload that has been encoded and hashed, and only needs to be
+  /// signed and sent (see prepareUpload)
+  struct PreparedUpload {
+    RequestBuilder* builder = nullptr;
+    /// bodyDigest is the SHA-256 of the request body
+    QByteArray bodyDigest;
+    /// errorText explains why the upload could not be prepared. If set, there is nothing to send
+    /// (builder is null).
+    QString errorText;
+  };
+
+  /// prepareUpload takes the given Evidence model, and encodes it (and the file) for upload to the
+  /// configured ASHIRT API server. The body is hashed on a worker thread; the returned future
+  /// resolves once that is done. Pass the result to sendUpload to actually upload the evidence.
+  /// If the evidence file cannot be opened, the result only holds an errorText.
   /// Note: does not specify the occurred_at field, so occurred_at will reflect the time of upload,
   /// rather than the time of capture.
-  static QNetworkReply* uploadAsset(model::Evidence evidence) {
+  static QFuture<PreparedUpload> prepareUpload(model::Evidence evidence) {
     MultipartParser parser;
     parser.addParameter(QStringLiteral("notes"), evidence.description);
     parser.addParameter(QStringLiteral("contentType"), evidence.contentType);
@@ -50,9 +78,83 @@ public:
 
     parser.addParameter(QStringLiteral("tagIds"), QStringLiteral("[%1]").arg(list.join(QStringLiteral(","))));
     parser.addFile(QStringLiteral("file"), evidence.path);
-    auto builder = ashirtFormPost(QStringLiteral("/api/operations/%1/evidence").arg(evidence.operationSlug), parser.generateBody(), parser.boundary());
-    addASHIRTAuth(builder);
-    return builder->execute(get()->nam);
+    // the body is streamed from disk, so large evidence is never held in memory
+    auto body = parser.generateStream();
+    if (body == nullptr) {
+      PreparedUpload failed;
+      failed.errorText = tr("Unable to read the evidence file (%1)").arg(evidence.path);
+      return QtFuture::makeReadyValueFuture(failed);
+    }
+    auto builder = ashirtFormPost(QStringLiteral("/api/operations/%1/evidence").arg(evidence.operationSlug), NO_BODY, parser.boundary())
+        ->setBodyDevice(body);
+    return hashDeviceAsync(builder->getBodyDevice()).then(get(), [builder](const QByteArray& digest) {
+      return PreparedUpload{builder, digest};
+    });
+  }
+
+  /// sendUpload signs and sends an upload from prepareUpload. Returns a QNetworkReply to track the
+  /// request. Signing is done here, rather than in prepareUpload, so that the Date header is current
+  /// even if the upload waited to be sent.
+  static QNetworkReply* sendUpload(const PreparedUpload& upload) {
+    addASHIRTDigestAuth(upload.builder, upload.bodyDigest);
+    return upload.builder->execute(get()->nam);
+  }
+
+  /// discardUpload releases an upload from prepareUpload that will not be sent
+  static void discardUpload(const PreparedUpload& upload) {
+    if (upload.builder == nullptr)
+      return;
+    delete upload.builder->getBodyDevice();
+    delete upload.builder;
+  }
+
+  /// ConnectionStats summarizes how the network connections have been used
+  struct ConnectionStats {
+    /// requests counts the completed requests
+    quint64 requests = 0;
+    /// http2Requests counts the requests that were multiplexed over an HTTP/2 connection
+    quint64 http2Requests = 0;
+    /// handshakes counts the TLS sessions established. Requests beyond this reused a connection.
+    quint64 handshakes = 0;
+    /// prewarms counts the connections opened ahead of use (see prewarmConnection)
+    quint64 prewarms = 0;
+  };
+
+  /// connectionStats returns the connection usage so far
+  static ConnectionStats connectionStats() { return get()->_connectionStats; }
+
+  /// prewarmInterval is how long (in ms) a prewarmed connection is assumed to stay open
+  inline static constexpr qint64 prewarmInterval = 60 * 1000;
+
+  /// prewarmConnection opens a connection to the configured ASHIRT API server ahead of use, so that
+  /// the next request does not wait on DNS, TCP and TLS. HTTP/2 is offered, so that a single
+  /// connection can carry every request. Does nothing if the same server was prewarmed within the
+  /// last prewarmInterval.
+  static void prewarmConnection() {
+    QUrl url(AppConfig::value(CONFIG::APIURL));
+    if (!url.isValid() || url.host().isEmpty())
+      return;
+    auto self = get();
+    const bool encrypted = url.scheme() == QStringLiteral("https");
+    const auto port = url.port(encrypted ? 443 : 80);
+    const auto server = QStringLiteral("%1://%2:%3").arg(url.scheme(), url.host()).arg(port);
+    if (server == self->_prewarmedServer && self->_prewarmedAt.isValid()
+        && self->_prewarmedAt.elapsed() < prewarmInterval)
+      return;
+
+    self->_prewarmedServer = server;
+    self->_prewarmedAt.start();
+    self->_connectionStats.prewarms++;
+    if (encrypted) {
+#if QT_CONFIG(ssl)
+      auto sslConfig = QSslConfiguration::defaultConfiguration();
+      sslConfig.setAllowedNextProtocols({QByteArray(QSslConfiguration::ALPNProtocolHTTP2),
+                                         QByteArray(QSslConfiguration::NextProtocolHttp1_1)});
+      self->nam->connectToHostEncrypted(url.host(), port, sslConfig);
+#endif
+    } else {
+      self->nam->connectToHost(url.host(), port);
+    }
   }
 
   ///Return the last Test Error
@@ -105,13 +207,77 @@ public:
     connect(get()->testConnectionReply, &QNetworkReply::finished, get(), processTestResults);
   }
 
-  /// getAllOperations retrieves all (user-visble) operations from the configured ASHIRT API server.
-  /// Note: normally you should opt to use refreshOperationsList and retrieve the results by listening
-  /// for the operationListUpdated signal.
-  static QNetworkReply *getAllOperations() {
-    auto builder = ashirtGet(QStringLiteral("/api/operations"));
+  /// CachedResponse is the result of a coalescedGet
+  struct CachedResponse {
+    /// ok is true if the request succeeded (including a 304 that was answered from memory)
+    bool ok = false;
+    /// notModified is true if the server reported that the last body is still current
+    bool notModified = false;
+    /// errorText describes why the request failed (if it did)
+    QString errorText;
+    QByteArray body;
+  };
+
+  /**
+   * @brief coalescedGet performs an (authenticated) GET against the ASHIRT API server, with two
+   * optimizations for data that is requested often, but rarely changes:
+   *  - Concurrent requests for the same endpoint share a single network request.
+   *  - The ETag / Last-Modified of each successful response is kept, along with its body, and sent
+   *    back (as If-None-Match / If-Modified-Since) on the next request. An unchanged response is
+   *    then a bodiless 304, answered with the kept body.
+   * Kept responses are also written to a disk cache, so that they outlive the application (see
+   * storedResponse).
+   * @param endpoint The API path, e.g. /api/operations
+   * @return a future for the response, resolved on the GUI thread
+   */
+  static QFuture<CachedResponse> coalescedGet(const QString& endpoint) {
+    auto self = get();
+    auto promise = std::make_shared<QPromise<CachedResponse>>();
+    auto future = promise->future();
+    promise->start();
+
+    const auto url = storeUrl(endpoint);
+    const auto key = url.toString();
+    auto pending = self->_pendingGets.find(key);
+    if (pending != self->_pendingGets.end()) {
+      pending->append(promise);
+      return future;
+    }
+    self->_pendingGets.insert(key, {promise});
+
+    auto builder = ashirtGet(endpoint);
+    if (auto validator = self->storedValidator(url)) {
+      if (!validator->etag.isEmpty())
+        builder->addRawHeader(QStringLiteral("If-None-Match"), QString::fromLatin1(validator->etag));
+      if (!validator->lastModified.isEmpty())
+        builder->addRawHeader(QStringLiteral("If-Modified-Since"), QString::fromLatin1(validator->lastModified));
+    }
     addASHIRTAuth(builder);
-    return builder->execute(get()->nam);
+    auto reply = builder->execute(self->nam);
+    connect(reply, &QNetworkReply::finished, self, [self, reply, url, key] {
+      const auto response = self->readCachedResponse(reply, url);
+      reply->deleteLater();
+      for (const auto& waiting : self->_pendingGets.take(key)) {
+        waiting->addResult(response);
+        waiting->finish();
+      }
+    });
+    return future;
+  }
+
+  /**
+   * @brief storedResponse returns the last good response to a coalescedGet of endpoint, from this
+   * run or (via the disk cache) a previous one, without making any request. This allows data to be
+   * shown immediately, and then refreshed with coalescedGet (i.e. stale-while-revalidate).
+   * @return the stored response. ok is false if nothing is stored.
+   */
+  static CachedResponse storedResponse(const QString& endpoint) {
+    CachedResponse response;
+    if (auto validator = get()->storedValidator(storeUrl(endpoint))) {
+      response.ok = true;
+      response.body = validator->body;
+    }
+    return response;
   }
 
   /// getGithubReleases retrieves the recent releases from github for the provided owner and repo.
@@ -125,18 +291,38 @@ public:
 
   /// refreshOperationsList retrieves the operations currently visible to the user. Results should be
   /// retrieved by listening for the operationListUpdated signal
+  /// On the first call, the operations from the last run (if any) are emitted straight away.
   static void refreshOperationsList() {
-    if (get()->allOpsReply)
+    if (get()->_refreshingOperations)
         return;
-    get()->allOpsReply = get()->getAllOperations();
-    connect(get()->allOpsReply, &QNetworkReply::finished, get(), &NetMan::onGetOpsComplete);
+    get()->_refreshingOperations = true;
+    bool servedStored = false;
+    if (!get()->_operationsRefreshed) {
+      auto stored = storedResponse(QStringLiteral("/api/operations"));
+      if (stored.ok) {
+        onGetOpsComplete(stored);
+        servedStored = true;
+      }
+    }
+    coalescedGet(QStringLiteral("/api/operations")).then(get(), [servedStored](const CachedResponse& response) {
+      get()->_refreshingOperations = false;
+      get()->_operationsRefreshed = get()->_operationsRefreshed || response.ok;
+      // once the stored list is showing, only a changed list is worth announcing: an unchanged one
+      // would only rebuild the same menus, and a failure would replace usable data with an error
+      if (servedStored && (response.notModified || !response.ok))
+        return;
+      onGetOpsComplete(response);
+    });
   }
 
   /// getOperationTags retrieves the tags for specified operation from the ASHIRT API server
-  static QNetworkReply *getOperationTags(QString operationSlug) {
-    auto builder = ashirtGet(QStringLiteral("/api/operations/%1/tags").arg(operationSlug));
-    addASHIRTAuth(builder);
-    return builder->execute(get()->nam);
+  static QFuture<CachedResponse> getOperationTags(const QString& operationSlug) {
+    return coalescedGet(QStringLiteral("/api/operations/%1/tags").arg(operationSlug));
+  }
+
+  /// storedOperationTags returns the last retrieved tags for the specified operation (see storedResponse)
+  static CachedResponse storedOperationTags(const QString& operationSlug) {
+    return storedResponse(QStringLiteral("/api/operations/%1/tags").arg(operationSlug));
   }
 
   /// createTag attempts to create a new tag for specified operation from the ASHIRT API server.
@@ -182,17 +368,46 @@ signals:
  void testStatusChanged(TestResult newStatus);
 
 private:
- NetMan(QObject * parent = nullptr) : QObject(parent), nam(new QNetworkAccessManager(this)) { }
+ /// diskCacheSize is the most (in bytes) that the disk cache of coalescedGet responses may hold
+ inline static constexpr qint64 diskCacheSize = 16 * 1024 * 1024;
+
+ /// Validator is what is kept of a coalescedGet response, in order to revalidate (and reuse) it
+ struct Validator {
+   QByteArray etag;
+   QByteArray lastModified;
+   QByteArray body;
+ };
+
+ NetMan(QObject * parent = nullptr)
+   : QObject(parent)
+   , nam(new QNetworkAccessManager(this))
+   , diskCache(new QNetworkDiskCache(this)) {
+   // the disk cache is used as a store for coalescedGet, and is deliberately not given to nam:
+   // revalidation is done by coalescedGet itself, with the ASHIRT authentication
+   diskCache->setCacheDirectory(QStringLiteral("%1/responses").arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)));
+   diskCache->setMaximumCacheSize(diskCacheSize);
+   connect(nam, &QNetworkAccessManager::finished, this, [this](QNetworkReply* reply) {
+     _connectionStats.requests++;
+     if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool())
+       _connectionStats.http2Requests++;
+   });
+#if QT_CONFIG(ssl)
+   connect(nam, &QNetworkAccessManager::encrypted, this, [this] { _connectionStats.handshakes++; });
+#endif
+ }
  NetMan(NetMan const &) = delete;
  void operator=(NetMan const &) = delete;
 
  ~NetMan() {
-    cleanUpReply(&get()->allOpsReply);
     cleanUpReply(&get()->testConnectionReply);
     cleanUpReply(&get()->githubReleaseReply);
  };
 
  QString _lastTestError;
+ ConnectionStats _connectionStats;
+ /// _prewarmedServer is the scheme://host:port last passed to prewarmConnection
+ QString _prewarmedServer;
+ QElapsedTimer _prewarmedAt;
 
  /// ashirtGet generates a basic GET request to the ashirt API server. No authentication is
  /// provided (use addASHIRTAuth to do this)
@@ -225,44 +440,84 @@ private:
 
  /// addASHIRTAuth takes the provided RequestBuilder and adds on Authorization and Date headers
  /// in order to properly authenticate with ASHIRT servers. Note that this should not be used for
- /// non-ashirt requests
+ /// non-ashirt requests. A streamed body is hashed on the calling thread; prefer hashDeviceAsync
+ /// and addASHIRTDigestAuth for anything large.
  static void addASHIRTAuth(RequestBuilder* reqBuilder, const QString& altApiKey = QString(),
                     const QString& altSecretKey = QString()) {
+   auto bodyDigest = reqBuilder->getBodyDevice() != nullptr
+       ? hashDevice(reqBuilder->getBodyDevice())
+       : QCryptographicHash::hash(reqBuilder->getBody(), QCryptographicHash::Sha256);
+   addASHIRTDigestAuth(reqBuilder, bodyDigest, altApiKey, altSecretKey);
+ }
+
+ /// addASHIRTDigestAuth is addASHIRTAuth for a request whose body has already been hashed (with
+ /// SHA-256). The Date header is stamped here, so sign just before the request is executed.
+ static void addASHIRTDigestAuth(RequestBuilder* reqBuilder, const QByteArray& bodyDigest,
+                                 const QString& altApiKey = QString(),
+                                 const QString& altSecretKey = QString()) {
    auto now = QDateTime::currentDateTimeUtc().toString(QStringLiteral("ddd, dd MMM yyyy hh:mm:ss 'GMT'"));
    reqBuilder->addRawHeader(QStringLiteral("Date"), now);
 
    // load default key if not present
    QString apiKeyCopy = altApiKey.isEmpty() ? AppConfig::value(CONFIG::ACCESSKEY) : QString(altApiKey);
 
-   auto code = generateHash(RequestMethodToString(reqBuilder->getMethod()),
-                            reqBuilder->getEndpoint(), now, reqBuilder->getBody(), altSecretKey);
-
+   auto code = generateDigestHash(RequestMethodToString(reqBuilder->getMethod()),
+                                  reqBuilder->getEndpoint(), now, bodyDigest, altSecretKey);
    auto authValue = QStringLiteral("%1:%2").arg(apiKeyCopy, code);
    reqBuilder->addRawHeader(QStringLiteral("Authorization"), authValue);
  }
 
 
- /// generateHash provides a cryptographic hash for ASHIRT api server communication
- static QString generateHash(QString method, QString path, QString date, QByteArray body = NO_BODY,
-                      const QString &secretKey = QString()) {
-
+ /// generateDigestHash provides a cryptographic hash for ASHIRT api server communication, given
+ /// the SHA-256 of the request body (see hashDevice)
+ static QString generateDigestHash(QString method, QString path, QString date,
+                                   const QByteArray &bodyDigest, const QString &secretKey = QString()) {
    QString msg  = QStringLiteral("%1\n%2\n%3\n").arg(method, path, date);
    QString secretKeyCopy = secretKey.isEmpty() ? AppConfig::value(CONFIG::SECRETKEY) : QString(secretKey);
 
    QMessageAuthenticationCode code(QCryptographicHash::Sha256);
    code.setKey(QByteArray::fromBase64(secretKeyCopy.toUtf8()));
    code.addData(msg.toLatin1());
-   code.addData(QCryptographicHash::hash(body, QCryptographicHash::Sha256));
+   code.addData(bodyDigest);
    return code.result().toBase64();
  }
 
+ /// bodyHashChunkSize is how much of a streamed body is read at a time while hashing it
+ inline static constexpr qint64 bodyHashChunkSize = 64 * 1024;
+
+ /// hashDevice computes the SHA-256 of the remaining content of device, reading it in fixed-size
+ /// chunks (so memory use does not depend on the body size), and then rewinds the device so that
+ /// it can be sent
+ static QByteArray hashDevice(QIODevice* device) {
+   QCryptographicHash hash(QCryptographicHash::Sha256);
+   QByteArray chunk(bodyHashChunkSize, Qt::Uninitialized);
+   qint64 read = 0;
+   while ((read = device->read(chunk.data(), chunk.size())) > 0)
+     hash.addData(QByteArrayView(chunk.constData(), read));
+   if (read < 0)
+     qWarning() << "Unable to read request body for signing: " << device->errorString();
+   device->reset();
+   return hash.result();
+ }
+
+ /// hashDeviceAsync runs hashDevice on a worker thread. device must not be used elsewhere until the
+ /// returned future has finished.
+ static QFuture<QByteArray> hashDeviceAsync(QIODevice* device) {
+   auto promise = std::make_shared<QPromise<QByteArray>>();
+   auto future = promise->future();
+   promise->start();
+   QThreadPool::globalInstance()->start([promise, device] {
+     promise->addResult(hashDevice(device));
+     promise->finish();
+   });
+   return future;
+ }
+
  /// onGetOpsComplete is called when the network request associated with the method refreshOperationsList
  /// completes. This will emit an operationListUpdated signal.
- static void onGetOpsComplete() {
-   bool isValid;
-   auto data = get()->extractResponse(get()->allOpsReply, isValid);
-   if (isValid) {
-     OperationVector ops = dto::Operation::parseDataAsList(data);
+ static void onGetOpsComplete(const CachedResponse& response) {
+   if (response.ok) {
+     OperationVector ops = dto::Operation::parseDataAsList(response.body);
      std::sort(ops.begin(), ops.end(),
                [](dto::Operation i, dto::Operation j) { return i.name < j.name; });
 
@@ -270,7 +525,94 @@ private:
    } else {
      Q_EMIT get()->operationListUpdated(false);
    }
-   cleanUpReply(&get()->allOpsReply);
+ }
+
+ /// storeUrl identifies a coalescedGet of endpoint. Responses depend on who is asking, so the
+ /// (digest of the) access key is included as the user, making a different key (or server) a
+ /// different entry.
+ static QUrl storeUrl(const QString& endpoint) {
+   QString base = AppConfig::value(CONFIG::APIURL);
+   if (base.endsWith(QLatin1Char('/')))
+     base.chop(1);
+   QUrl url(base + endpoint);
+   const auto keyDigest = QCryptographicHash::hash(AppConfig::value(CONFIG::ACCESSKEY).toUtf8(),
+                                                   QCryptographicHash::Sha256);
+   url.setUserName(QString::fromLatin1(keyDigest.toHex().left(16)));
+   return url;
+ }
+
+ /// storedValidator returns the validator kept for url, loading it from the disk cache if it was
+ /// stored by a previous run
+ std::optional<Validator> storedValidator(const QUrl& url) {
+   const auto key = url.toString();
+   auto found = _validators.constFind(key);
+   if (found != _validators.cend())
+     return *found;
+
+   std::unique_ptr<QIODevice> data(diskCache->data(url));
+   if (!data)
+     return std::nullopt;
+   Validator loaded;
+   for (const auto& header : diskCache->metaData(url).rawHeaders()) {
+     if (header.first == "ETag")
+       loaded.etag = header.second;
+     else if (header.first == "Last-Modified")
+       loaded.lastModified = header.second;
+   }
+   loaded.body = data->readAll();
+   _validators.insert(key, loaded);
+   return loaded;
+ }
+
+ /// storeValidator keeps validator for url, in memory and in the disk cache
+ void storeValidator(const QUrl& url, const Validator& validator) {
+   _validators.insert(url.toString(), validator);
+
+   QNetworkCacheMetaData meta;
+   meta.setUrl(url);
+   meta.setSaveToDisk(true);
+   meta.setLastModified(QDateTime::currentDateTimeUtc());
+   QNetworkCacheMetaData::RawHeaderList headers;
+   if (!validator.etag.isEmpty())
+     headers.append({QByteArrayLiteral("ETag"), validator.etag});
+   if (!validator.lastModified.isEmpty())
+     headers.append({QByteArrayLiteral("Last-Modified"), validator.lastModified});
+   meta.setRawHeaders(headers);
+
+   // prepare returns nullptr if the entry cannot be saved (e.g. is larger than the cache)
+   if (auto device = diskCache->prepare(meta)) {
+     device->write(validator.body);
+     diskCache->insert(device);
+   }
+ }
+
+ /// readCachedResponse interprets a finished coalescedGet reply, answering a 304 from (and
+ /// otherwise updating) the validator stored for url
+ CachedResponse readCachedResponse(QNetworkReply* reply, const QUrl& url) {
+   CachedResponse response;
+   const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+   if (reply->error() != QNetworkReply::NoError) {
+     response.errorText = reply->errorString();
+     return response;
+   }
+
+   auto validator = storedValidator(url);
+   if (status == HttpStatus::StatusNotModified && validator) {
+     response.ok = true;
+     response.notModified = true;
+     response.body = validator->body;
+     return response;
+   }
+   if (status != HttpStatus::StatusOK) {
+     response.errorText = tr("Unexpected response (code %1)").arg(status);
+     return response;
+   }
+
+   response.ok = true;
+   response.body = reply->readAll();
+   // the body is kept even without an ETag / Last-Modified, as it is still worth showing next time
+   storeValidator(url, {reply->rawHeader("ETag"), reply->rawHeader("Last-Modified"), response.body});
+   return response;
  }
 
  /// onGithubReleasesComplete is called when the network request associated with the method checkForNewRelease
@@ -286,10 +628,18 @@ private:
    }
    cleanUpReply(&get()->githubReleaseReply);
  }
- QNetworkReply *allOpsReply = nullptr;
+ /// _validators holds the last response for each coalescedGet, by request key
+ QHash<QString, Validator> _validators;
+ /// _pendingGets holds those waiting on each in-progress coalescedGet, by request key
+ QHash<QString, QList<std::shared_ptr<QPromise<CachedResponse>>>> _pendingGets;
+ bool _refreshingOperations = false;
+ /// _operationsRefreshed is true once the operations have been retrieved from the server (rather
+ /// than only from the disk cache)
+ bool _operationsRefreshed = false;
  QNetworkReply *testConnectionReply = nullptr;
  QNetworkReply *githubReleaseReply = nullptr;
  QNetworkAccessManager *nam = nullptr;
+ QNetworkDiskCache *diskCache = nullptr;
 };
 
 // TestResult is emitted across the testStatusChanged signal; declaring it as a
@@ -39,6 +39,8 @@ class RequestBuilder {
  private:
   RequestMethod method = RequestMethod::METHOD_GET;
   QByteArray body = NO_BODY;
+  /// bodyDevice, if set, is streamed as the body (instead of body)
+  QIODevice* bodyDevice = nullptr;
   QString host;
   QString endpoint;
 
@@ -49,6 +51,9 @@ class RequestBuilder {
 
   // creators (constructors + Psuedo constructors)
  public:
+  /// keepAliveSeconds is how long an idle connection is kept open, for reuse by later requests
+  inline static constexpr int keepAliveSeconds = 300;
+
   RequestBuilder() = default;
   ~RequestBuilder() = default;
 
@@ -86,6 +91,11 @@ class RequestBuilder {
     return this->body;
   }
 
+  /// getBodyDevice retrieves the set body device (or nullptr, if the body is not streamed)
+  QIODevice* getBodyDevice() {
+    return this->bodyDevice;
+  }
+
   /// getEndpoint retrieves the set endpoint
   QString getEndpoint() {
     return this->endpoint;
@@ -119,6 +129,14 @@ class RequestBuilder {
     return this;
   }
 
+  /// setBodyDevice sets a device to stream as the body for this request, rather than an in-memory
+  /// body. The device must be open, and support seeking (so that the request can be re-sent). Once
+  /// the request is executed, the device is owned by the reply.
+  RequestBuilder* setBodyDevice(QIODevice* device) {
+    this->bodyDevice = device;
+    return this;
+  }
+
   /// setHost sets the host for this request
   RequestBuilder* setHost(QString host) {
     this->host = host;
@@ -158,6 +176,9 @@ class RequestBuilder {
     }
     url += endpoint;
     req.setUrl(url);
+    req.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    // keep idle connections open between (often sparse) requests, rather than reconnecting
+    req.setAttribute(QNetworkRequest::ConnectionCacheExpiryTimeoutSecondsAttribute, keepAliveSeconds);
 
     return req;
   }
@@ -178,7 +199,13 @@ class RequestBuilder {
         reply = nam->get(req);
         break;
       case RequestMethod::METHOD_POST:
-        reply = nam->post(req, body);
+        if (bodyDevice != nullptr) {
+          reply = nam->post(req, bodyDevice);
+          // the device must outlive the upload, which ends with the reply
+          bodyDevice->setParent(reply);
+        } else {
+          reply = nam->post(req, body);
+        }
         break;
       default:
         qWarning() << "Requestbuilder contains an unsupported request method";
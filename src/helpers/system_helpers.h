@@ -22,6 +22,14 @@ class SystemHelpers {
     QDir().mkpath(root);
     return root;
   }
+
+  /// Returns the root of the content-addressed evidence store (see FileHelpers::moveToContentStore),
+  /// or an empty string if identical evidence should not be shared (see CONFIG::SHARE_IDENTICAL_EVIDENCE)
+  static QString pathToEvidenceStore() {
+    if (AppConfig::value(CONFIG::SHARE_IDENTICAL_EVIDENCE) != QStringLiteral("true"))
+      return QString();
+    return QStringLiteral("%1/blobs").arg(AppConfig::value(CONFIG::EVIDENCEREPO));
+  }
   static bool isLightTheme() {
     // QStyleHints::colorScheme() (Qt 6.5+) reports the platform theme directly
     // on Windows, macOS, and Linux. Treat an Unknown scheme as light.
@@ -1,10 +1,14 @@
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QMessageBox>
 #include <QMetaType>
 
 #include "db/databaseconnection.h"
+#include "db/databaseconnectionpool.h"
+#include "db/databaseworker.h"
 #include "helpers/netman.h"
 #include "traymanager.h"
+#include "uploadqueue.h"
 
 QIcon getWindowIcon() { return QIcon(QStringLiteral(":icons/windowIcon.png")); }
 
@@ -15,6 +19,8 @@ void showMsgBox(const QString &errorText = QString())
 
 int main(int argc, char* argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
     Q_INIT_RESOURCE(res_icons);
     Q_INIT_RESOURCE(res_migrations);
 
@@ -35,20 +41,32 @@ int main(int argc, char* argv[])
         return -1;
     }
 
-    auto conn = new DatabaseConnection(Constants::dbLocation, Constants::defaultDbName);
-    if(!conn->connect()) {
-        showMsgBox(QString(QT_TRANSLATE_NOOP("main", "Database Error: %1")).arg(conn->errorString()));
+    const auto appReadyMs = startupTimer.elapsed();
+    auto conn = DatabaseConnectionPool::get()->connectionForCurrentThread();
+    if(!conn) {
+        showMsgBox(QString(QT_TRANSLATE_NOOP("main", "Database Error: %1")).arg(DatabaseConnectionPool::get()->lastError()));
         return -1;
     }
 
     app.setQuitOnLastWindowClosed(false);
     qRegisterMetaType<model::Tag>();
     qRegisterMetaType<NetMan::TestResult>();
+    const auto dbReadyMs = startupTimer.elapsed();
     auto window = new TrayManager(nullptr, conn);
+    const auto trayReadyMs = startupTimer.elapsed();
+    qInfo() << "Startup took" << trayReadyMs << "ms: application" << appReadyMs
+            << "ms, database" << dbReadyMs - appReadyMs << "ms, tray" << trayReadyMs - dbReadyMs << "ms";
 
-    QObject::connect(&app, &QApplication::aboutToQuit, [conn] {
-        conn->close();
-        delete conn;
+    // resume any uploads left over from the last run
+    UploadQueue::get()->start();
+
+    QObject::connect(&app, &QApplication::aboutToQuit, [] {
+        UploadQueue::get()->stop();
+        const auto net = NetMan::connectionStats();
+        qInfo() << "Network:" << net.requests << "requests," << net.http2Requests << "over HTTP/2,"
+                << net.handshakes << "TLS handshakes," << net.prewarms << "prewarmed connections";
+        DatabaseWorker::get()->shutdown();
+        DatabaseConnectionPool::get()->releaseConnectionForCurrentThread();
     });
 
     int rtn = app.exec();
@@ -7,12 +7,18 @@
 namespace model {
 class Evidence {
  public:
-  qint64 id;
+  /// id is -1 until the evidence has been read (e.g. when a database read is dropped)
+  qint64 id = -1;
   QString path;
   QString operationSlug;
   QString description;
   QString errorText;
   QString contentType;
+  /// contentText is the searchable text of the evidence itself (e.g. a codeblock's source). Empty
+  /// for content types that have no text, like images.
+  QString contentText;
+  /// contentHash is the hex-encoded SHA-256 of the evidence file. Empty until it has been computed.
+  QString contentHash;
   QDateTime recordedDate;
   QDateTime uploadDate;
   QList<Tag> tags;
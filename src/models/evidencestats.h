@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QCoreApplication>
+#include <QStringList>
+
+namespace model {
+/// EvidenceStats counts evidence by upload status. Each evidence is counted exactly once: submitted
+/// evidence has been uploaded, failed evidence has an upload error, and everything else is pending.
+class EvidenceStats {
+  Q_DECLARE_TR_FUNCTIONS(EvidenceStats)
+
+ public:
+  qint64 pending = 0;
+  qint64 failed = 0;
+  qint64 submitted = 0;
+
+  [[nodiscard]] qint64 total() const { return pending + failed + submitted; }
+
+  /// summary renders the unfinished work, e.g. "12 unsubmitted, 3 failed"
+  [[nodiscard]] QString summary() const {
+    QStringList parts;
+    if (pending > 0)
+      parts.append(tr("%n unsubmitted", nullptr, int(pending)));
+    if (failed > 0)
+      parts.append(tr("%n failed", nullptr, int(failed)));
+    if (parts.isEmpty())
+      return total() > 0 ? tr("All evidence submitted") : tr("No evidence");
+    return parts.join(QStringLiteral(", "));
+  }
+};
+}  // namespace model
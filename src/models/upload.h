@@ -0,0 +1,25 @@
+#pragma once
+
+#include "evidence.h"
+
+namespace model {
+/// UploadState tracks evidence through the upload queue. The values are stored in the database.
+enum class UploadState {
+  /// QUEUED evidence is waiting for its (next) attempt
+  QUEUED = 0,
+  /// UPLOADING evidence has an attempt in progress
+  UPLOADING = 1,
+  /// DONE evidence has been uploaded
+  DONE = 2,
+  /// FAILED evidence could not be uploaded, and will not be retried unless queued again
+  FAILED = 3
+};
+
+/// QueuedUpload is evidence that has been claimed from the upload queue, for one attempt
+class QueuedUpload {
+ public:
+  Evidence evidence;
+  /// attempt counts the attempts made to upload the evidence, including this one
+  int attempt = 0;
+};
+}  // namespace model
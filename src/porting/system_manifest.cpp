@@ -1,5 +1,9 @@
 #include "system_manifest.h"
 
+#include <QHash>
+#include <algorithm>
+
+#include "db/dbtransaction.h"
 #include "helpers/string_helpers.h"
 
 using namespace porting;
@@ -26,35 +30,72 @@ void SystemManifest::migrateDb(DatabaseConnection* systemDb)
     auto evidenceManifest = EvidenceManifest::deserialize(pathToFile(evidenceManifestPath));
     Q_EMIT onReady(evidenceManifest.entries.size());
     DatabaseConnection::withConnection(
-                pathToFile(dbPath), QStringLiteral("importDb"), [this, evidenceManifest, systemDb](DatabaseConnection importDb) {
+                pathToFile(dbPath), QStringLiteral("importDb"), [this, evidenceManifest, systemDb](DatabaseConnection& importDb) {
         Q_EMIT onStatusUpdate(tr("Importing evidence"));
-        for (size_t entryIndex = 0; entryIndex < evidenceManifest.entries.size(); entryIndex++) {
-            Q_EMIT onFileProcessed(entryIndex); // this only makes sense on the 2nd+ iteration, but this works since indexes start at 0
-            auto item = evidenceManifest.entries.at(entryIndex);
-            auto importRecord = importDb.getEvidenceDetails(item.evidenceID);
-            if (importRecord.id == 0)
-                continue; // in the odd situation that evidence doesn't match up, just skip it
-            QString newEvidencePath = QStringLiteral("%1/%2/%3")
-                    .arg(AppConfig::value(CONFIG::EVIDENCEREPO)
-                         , importRecord.operationSlug
-                         , contentSensitiveFilename(importRecord.contentType));
-
-            auto fullFileExportPath = m_fileTemplate.arg(m_pathToManifest, item.exportPath);
-            auto parentDir = FileHelpers::getDirname(newEvidencePath);
-            if (!QDir().exists(parentDir))
-                QDir().mkpath(parentDir);
-            QFile srcFile(fullFileExportPath);
-            srcFile.copy(newEvidencePath);
-            if (srcFile.error() != QFileDevice::NoError) {
-                Q_EMIT onCopyFileError(
-                            fullFileExportPath, newEvidencePath,
-                            QStringLiteral("Unable to write to file: %1\n%2").arg(newEvidencePath, srcFile.error()));
-                return;
-            }
+        QList<qint64> evidenceIDs;
+        evidenceIDs.reserve(evidenceManifest.entries.size());
+        for (const auto &entry : evidenceManifest.entries)
+            evidenceIDs.append(entry.evidenceID);
+        QHash<qint64, model::Evidence> importRecords;
+        const auto allImportRecords = importDb.getEvidenceDetails(evidenceIDs);
+        const auto importContentText = importDb.getEvidenceContentText(evidenceIDs);
+        for (auto record : allImportRecords) {
+            record.contentText = importContentText.value(record.id);
+            importRecords.insert(record.id, record);
+        }
 
-            importRecord.path = newEvidencePath;
-            qint64 evidenceID = systemDb->createFullEvidence(importRecord);
-            systemDb->setEvidenceTags(importRecord.tags, evidenceID);
+        // insertBatch records the copied evidence in one short transaction
+        auto insertBatch = [systemDb](const QList<model::Evidence> &copied) {
+            DBTransaction transaction(systemDb);
+            for (const auto &importRecord : copied) {
+                qint64 evidenceID = systemDb->createFullEvidence(importRecord);
+                systemDb->setEvidenceTags(importRecord.tags, evidenceID);
+            }
+            transaction.commit();
+        };
+
+        // Entries are imported in batches of importBatchSize. Each batch's files are copied before
+        // its transaction starts, so the write lock is only held for the inserts, and is released
+        // between batches for the rest of the app.
+        const size_t importBatchSize = 250;
+        const size_t entryCount = evidenceManifest.entries.size();
+        for (size_t batchStart = 0; batchStart < entryCount; batchStart += importBatchSize) {
+            const size_t batchEnd = std::min(batchStart + importBatchSize, entryCount);
+            QList<model::Evidence> copied;
+            copied.reserve(batchEnd - batchStart);
+            for (size_t entryIndex = batchStart; entryIndex < batchEnd; entryIndex++) {
+                Q_EMIT onFileProcessed(entryIndex); // this only makes sense on the 2nd+ iteration, but this works since indexes start at 0
+                auto item = evidenceManifest.entries.at(entryIndex);
+                auto foundRecord = importRecords.constFind(item.evidenceID);
+                if (foundRecord == importRecords.constEnd())
+                    continue; // in the odd situation that evidence doesn't match up, just skip it
+                auto importRecord = foundRecord.value();
+                QString newEvidencePath = QStringLiteral("%1/%2/%3")
+                        .arg(AppConfig::value(CONFIG::EVIDENCEREPO)
+                             , importRecord.operationSlug
+                             , contentSensitiveFilename(importRecord.contentType));
+
+                auto fullFileExportPath = m_fileTemplate.arg(m_pathToManifest, item.exportPath);
+                auto parentDir = FileHelpers::getDirname(newEvidencePath);
+                if (!QDir().exists(parentDir))
+                    QDir().mkpath(parentDir);
+                QFile srcFile(fullFileExportPath);
+                srcFile.copy(newEvidencePath);
+                if (srcFile.error() != QFileDevice::NoError) {
+                    Q_EMIT onCopyFileError(
+                                fullFileExportPath, newEvidencePath,
+                                QStringLiteral("Unable to write to file: %1\n%2").arg(newEvidencePath, srcFile.error()));
+                    insertBatch(copied); // keep the evidence that was copied successfully
+                    return;
+                }
+
+                importRecord.path = newEvidencePath;
+                // exports from older versions did not include codeblock content
+                if (importRecord.contentType == Codeblock::contentType() && importRecord.contentText.isEmpty())
+                    importRecord.contentText = Codeblock::readCodeblock(newEvidencePath).content;
+                copied.append(importRecord);
+            }
+            insertBatch(copied);
         }
         Q_EMIT onFileProcessed(evidenceManifest.entries.size()); // update the full set now that this is complete
     });
@@ -112,9 +153,23 @@ void SystemManifest::exportManifest(DatabaseConnection* db, const QString& outpu
         Q_EMIT onStatusUpdate(tr("Exporting Evidence"));
         dbPath = QStringLiteral("db.sqlite");
         evidenceManifestPath = QStringLiteral("evidence.json");
-        auto allEvidence = DatabaseConnection::createEvidenceExportView(m_fileTemplate.arg(basePath, dbPath), EvidenceFilters(), db);
-        Q_EMIT onReady(allEvidence.size());
-        porting::EvidenceManifest evidenceManifest = copyEvidence(basePath, allEvidence);
+        const auto exportFilters = EvidenceFilters();
+        Q_EMIT onReady(std::max<qint64>(db->countEvidenceWithFilters(exportFilters), 0));
+        QDir().mkpath(m_fileTemplate.arg(basePath, m_evidenceDir));
+
+        // each page of evidence has its files copied as soon as it is in the export database
+        porting::EvidenceManifest evidenceManifest;
+        quint64 processedCount = 0;
+        bool exported = DatabaseConnection::createEvidenceExportView(
+            m_fileTemplate.arg(basePath, dbPath), exportFilters, db,
+            [this, &basePath, &evidenceManifest, &processedCount](
+                const QList<model::Evidence>& page) {
+                copyEvidence(basePath, page, evidenceManifest, processedCount);
+            });
+        if (!exported) {
+            Q_EMIT onExportError(tr("Unable to export the evidence database"));
+            return;
+        }
         // write evidence manifest
         FileHelpers::writeFile(m_fileTemplate.arg(basePath, evidenceManifestPath),
                                QJsonDocument(EvidenceManifest::serialize(evidenceManifest)).toJson());
@@ -127,27 +182,23 @@ void SystemManifest::exportManifest(DatabaseConnection* db, const QString& outpu
         Q_EMIT onExportError(QStringLiteral("Error On Exporting manifest"));
 }
 
-porting::EvidenceManifest SystemManifest::copyEvidence(const QString& baseExportPath,
-                                                       QList<model::Evidence> allEvidence)
+void SystemManifest::copyEvidence(const QString& baseExportPath,
+                                  const QList<model::Evidence>& evidence,
+                                  porting::EvidenceManifest& evidenceManifest,
+                                  quint64& processedCount)
 {
-    QString relativeEvidenceDir = QStringLiteral("evidence");
-    QDir().mkpath(m_fileTemplate.arg(baseExportPath, relativeEvidenceDir));
-
-    porting::EvidenceManifest evidenceManifest;
-    for (size_t evidenceIndex = 0; evidenceIndex < allEvidence.size(); evidenceIndex++) {
-        auto evi = allEvidence.at(evidenceIndex);
+    for (const auto &evi : evidence) {
         auto newName = QStringLiteral("ashirt_evidence_%1.%2")
                 .arg(StringHelpers::randomString(10), contentSensitiveExtension(evi.contentType));
-        auto item = porting::EvidenceItem(evi.id, m_fileTemplate.arg(relativeEvidenceDir, newName));
+        auto item = porting::EvidenceItem(evi.id, m_fileTemplate.arg(m_evidenceDir, newName));
         auto dstPath = m_fileTemplate.arg(baseExportPath, item.exportPath);
         QFile srcFile(evi.path);
         if(!srcFile.copy(dstPath))
             Q_EMIT onCopyFileError(evi.path, dstPath, srcFile.errorString());
         else
             evidenceManifest.entries.append(item);
-        Q_EMIT onFileProcessed(evidenceIndex + 1);
+        Q_EMIT onFileProcessed(++processedCount);
     }
-    return evidenceManifest;
 }
 
 QJsonObject SystemManifest::serialize(const SystemManifest& src)
@@ -107,19 +107,25 @@ namespace porting {
     QString pathToFile(const QString& filename);
 
     /**
-    * @brief copyEvidence will iteratively copy all evidence files provided to the indicated path. Files are renamed
-    * to avoid any name collisions. Files are namespaced into givenPath/evidence
+    * @brief copyEvidence will iteratively copy the given evidence files to the indicated path, adding
+    * each copy to evidenceManifest. Files are renamed to avoid any name collisions. Files are
+    * namespaced into givenPath/evidence
     * This emits a onCopyFileError signal if there is an issue copying files
     * This emits a onFileProcessed signal when the attempted copy completes (so you may get an error _and_ processed signal on the same file. Error will be first)
     * @param baseExportPath The path to the desired export directory
-    * @param allEvidence a vector of evidence _data_ to export (files will be found and read from within this function)
-    * @return an EvidenceManifest listing all of the files copied, and their new names.
+    * @param evidence a page of evidence _data_ to export (files will be found and read from within
+    * this function)
+    * @param evidenceManifest the manifest that each copied file is added to, with its new name
+    * @param processedCount the number of files processed so far, across pages (updated as files
+    * are copied)
     */
-    porting::EvidenceManifest copyEvidence(const QString& baseExportPath,
-                                             QList<model::Evidence> allEvidence);
+    void copyEvidence(const QString& baseExportPath, const QList<model::Evidence>& evidence,
+                      porting::EvidenceManifest& evidenceManifest, quint64& processedCount);
 
     /// pathToManifest is the (absolute) path to the system manifest file from the originating export
     QString m_pathToManifest;
     inline static const QString m_fileTemplate = QStringLiteral("%1/%2");
+    /// m_evidenceDir is the (relative) directory that exported evidence files are copied into
+    inline static const QString m_evidenceDir = QStringLiteral("evidence");
   };
 }
@@ -10,20 +10,28 @@
 #include <QMenu>
 #include <QMessageBox>
 #include <QMimeData>
+#include <QPromise>
 #include <QStyleHints>
+#include <QThreadPool>
 #include <QTimer>
+#include <algorithm>
 #include <chrono>
 #include <QDesktopServices>
 #include <iostream>
 #include "appconfig.h"
+#include "components/tagging/tag_cache/tagcache.h"
 #include "db/databaseconnection.h"
+#include "db/databaseworker.h"
+#include "db/dbtransaction.h"
 #include "forms/getinfo/getinfo.h"
+#include "helpers/file_helpers.h"
 #include "helpers/netman.h"
 #include "helpers/screenshot.h"
 #include "helpers/releaseinfo.h"
 #include "helpers/system_helpers.h"
 #include "hotkeymanager.h"
 #include "models/codeblock.h"
+#include "uploadqueue.h"
 #include "firstRunWizard/firstTimeWizard.h"
 #include "firstRunWizard/welcomepage.h"
 
@@ -39,6 +47,7 @@ TrayManager::TrayManager(QWidget * parent, DatabaseConnection* db)
     , exportWindow(new PortingDialog(PortingDialog::Export, this->db, this))
     , createOperationWindow(new CreateOperation(this))
     , newOperationAction(new QAction(tr("Connect to server first"), this))
+    , evidenceStatsAction(new QAction(this))
     , trayIcon(new QSystemTrayIcon(getTrayIcon(),this))
     , allOperationActions(this)
 
@@ -58,8 +67,12 @@ TrayManager::TrayManager(QWidget * parent, DatabaseConnection* db)
                       "Capture actions are still available from the tray menu."));
 
   // delayed so that windows can listen for get all ops signal
+  NetMan::prewarmConnection();
   NetMan::refreshOperationsList();
+  TagCache::get()->prefetch(AppConfig::operationSlug());
   QTimer::singleShot(5s, this, &TrayManager::checkForUpdate);
+  QTimer::singleShot(0, this, &TrayManager::indexCodeblockContent);
+  QTimer::singleShot(0, this, [this] { hashEvidenceContent(); });
 
   if(AppConfig::value(CONFIG::SHOW_WELCOME_SCREEN) != "false")
     showWelcomeScreen();
@@ -73,6 +86,8 @@ TrayManager::~TrayManager() {
 void TrayManager::buildUi() {
   //Disable Actions
   newOperationAction->setEnabled(false);  // only enable when we have an internet connection
+  evidenceStatsAction->setEnabled(false);  // informational only
+  evidenceStatsAction->setVisible(false);  // shown once an operation is selected
 
   // Build Tray menu
   auto trayIconMenu = new QMenu(this);
@@ -80,6 +95,7 @@ void TrayManager::buildUi() {
   trayIconMenu->addAction(tr("Capture Screen Area"), this, &TrayManager::captureAreaActionTriggered);
   trayIconMenu->addAction(tr("Capture Window"), this, &TrayManager::captureWindowActionTriggered);
   trayIconMenu->addAction(tr("View Accumulated Evidence"), evidenceManagerWindow, &EvidenceManager::show);
+  trayIconMenu->addAction(evidenceStatsAction);
   trayIconMenu->addSeparator();
   chooseOpSubmenu = trayIconMenu->addMenu(tr("Select Operation"));
   trayIconMenu->addSeparator();
@@ -97,6 +113,7 @@ void TrayManager::buildUi() {
   importExportSubmenu->addAction(tr("Import Data"), importWindow, &PortingDialog::show);
 
   setActiveOperationLabel();
+  refreshEvidenceStats();
 
   trayIcon->setContextMenu(trayIconMenu);
   trayIcon->show();
@@ -128,11 +145,20 @@ void TrayManager::wireUi() {
   connect(NetMan::get(), &NetMan::operationListUpdated, this, &TrayManager::onOperationListUpdated);
   connect(NetMan::get(), &NetMan::releasesChecked, this, &TrayManager::onReleaseCheck);
   connect(AppConfig::get(), &AppConfig::operationChanged, this, &TrayManager::setActiveOperationLabel);
+  connect(AppConfig::get(), &AppConfig::operationChanged, this, &TrayManager::refreshEvidenceStats);
+  connect(AppConfig::get(), &AppConfig::operationChanged, this, [] { NetMan::prewarmConnection(); });
+  connect(AppConfig::get(), &AppConfig::operationChanged, TagCache::get(), &TagCache::prefetch);
+  connect(UploadQueue::get(), &UploadQueue::uploadStateChanged, this,
+          [this](qint64, model::UploadState state) {
+    if (state == model::UploadState::DONE || state == model::UploadState::FAILED)
+      refreshEvidenceStats();
+  });
 
   connect(trayIcon, &QSystemTrayIcon::messageClicked, this, &TrayManager::onTrayMessageClicked);
   connect(trayIcon, &QSystemTrayIcon::activated, this, [this] {
     newOperationAction->setEnabled(false);
     NetMan::refreshOperationsList();
+    refreshEvidenceStats();
   });
 
   connect(updateCheckTimer, &QTimer::timeout, this, &TrayManager::checkForUpdate);
@@ -181,17 +207,149 @@ void TrayManager::showWelcomeScreen()
 
 void TrayManager::spawnGetInfoWindow(qint64 evidenceID) {
   auto getInfoWindow = new GetInfo(db, evidenceID, this);
-  connect(getInfoWindow, &GetInfo::evidenceSubmitted, [](const model::Evidence& evi) {
+  connect(getInfoWindow, &GetInfo::evidenceSubmitted, this, [this](const model::Evidence& evi) {
     AppConfig::setLastUsedTags(evi.tags);
+    refreshEvidenceStats();
   });
   getInfoWindow->show();
 }
 
-qint64 TrayManager::createNewEvidence(const QString& filepath, const QString& evidenceType) {
-  auto evidenceID = db->createEvidence(filepath, AppConfig::operationSlug(), evidenceType);
+/// hashEvidenceFiles computes the content hash (see FileHelpers::sha256) of each of paths (keyed by
+/// evidence id) on the global thread pool. Files that cannot be read are left out of the result.
+static QFuture<QHash<qint64, QString>> hashEvidenceFiles(const QHash<qint64, QString>& paths) {
+  auto promise = std::make_shared<QPromise<QHash<qint64, QString>>>();
+  auto future = promise->future();
+  promise->start();
+  QThreadPool::globalInstance()->start([promise, paths] {
+    QHash<qint64, QString> hashes;
+    for (auto it = paths.cbegin(); it != paths.cend(); ++it) {
+      auto contentHash = FileHelpers::sha256(it.value());
+      if (!contentHash.isEmpty())
+        hashes.insert(it.key(), contentHash);
+    }
+    promise->addResult(hashes);
+    promise->finish();
+  });
+  return future;
+}
+
+QFuture<TrayManager::NewEvidence> TrayManager::createNewEvidence(const QString& filepath,
+                                                                 const QString& evidenceType,
+                                                                 const QString& contentText) {
+  // AppConfig is only read on the GUI thread; the worker receives copies
+  auto operationSlug = AppConfig::operationSlug();
   auto tags = AppConfig::getLastUsedTags();
-  db->setEvidenceTags(tags, evidenceID);
-  return evidenceID;
+  // codeblocks can be edited in place, so only screenshots are shared through the store
+  auto storeRoot = evidenceType == Screenshot::contentType() ? SystemHelpers::pathToEvidenceStore()
+                                                             : QString();
+  // the capture is hashed on the global pool, so that the (single) database thread is only held
+  // for the writes
+  return FileHelpers::sha256Async(filepath).then([=](const QString& contentHash) {
+    return DatabaseWorker::get()->run([=](DatabaseConnection* conn) {
+      NewEvidence rtn;
+      qint64 evidenceID = -1;
+      {
+        DBTransaction transaction(conn);
+        evidenceID = conn->createEvidence(filepath, operationSlug, evidenceType, contentText, contentHash);
+        if (evidenceID == -1)
+          return rtn;
+        if (!conn->setEvidenceTags(tags, evidenceID)) {
+          qWarning() << "Unable to tag new evidence: " << conn->errorString();
+          return rtn;  // rolled back
+        }
+        if (!transaction.commit())
+          return rtn;
+      }
+      rtn.evidenceID = evidenceID;
+
+      // the capture is only moved once it is recorded, so that a failed write never loses it
+      if (!storeRoot.isEmpty() && !contentHash.isEmpty()) {
+        auto storedPath = FileHelpers::moveToContentStore(filepath, storeRoot, contentHash);
+        if (storedPath != filepath && !conn->updateEvidencePath(storedPath, evidenceID)) {
+          // the evidence still refers to the original path, so put a copy back there (the stored
+          // file may be shared, so it stays where it is)
+          qWarning() << "Unable to record stored evidence path: " << conn->errorString();
+          QFile::copy(storedPath, filepath);
+        }
+      }
+      rtn.duplicateOfID = conn->findDuplicateEvidence(contentHash, operationSlug, evidenceID);
+      return rtn;
+    });
+  }).unwrap();
+}
+
+void TrayManager::onEvidenceCreated(const NewEvidence& created) {
+  if (created.evidenceID <= 0) {
+    showDBWriteErrorTrayMessage();
+    return;
+  }
+  if (created.duplicateOfID > 0) {
+    setTrayMessage(MessageType::NO_ACTION, tr("Duplicate Evidence"),
+                   tr("This capture is identical to evidence already recorded for this operation."),
+                   QSystemTrayIcon::Information);
+  }
+  spawnGetInfoWindow(created.evidenceID);
+  refreshEvidenceStats();
+}
+
+void TrayManager::refreshEvidenceStats() {
+  auto operationSlug = AppConfig::operationSlug();
+  if (operationSlug.isEmpty()) {
+    evidenceStatsAction->setVisible(false);
+    trayIcon->setToolTip(QCoreApplication::applicationName());
+    return;
+  }
+  DatabaseWorker::get()->run([operationSlug](DatabaseConnection* conn) {
+    return conn->getEvidenceStats(operationSlug);
+  }).then(this, [this](const model::EvidenceStats& stats) {
+    evidenceStatsAction->setText(stats.summary());
+    evidenceStatsAction->setVisible(true);
+    trayIcon->setToolTip(QStringLiteral("%1\n%2").arg(QCoreApplication::applicationName(), stats.summary()));
+  });
+}
+
+void TrayManager::hashEvidenceContent(qint64 afterEvidenceID) {
+  // batches keep the worker free for other requests while a large repository is hashed. Files are
+  // hashed off of the worker, and outside of any transaction, so that the database is only locked
+  // while the hashes are written.
+  constexpr int batchSize = 100;
+  DatabaseWorker::get()->run([afterEvidenceID](DatabaseConnection* conn) {
+    return conn->getEvidencePathsWithoutContentHash(afterEvidenceID, batchSize);
+  }).then(this, [this](const QHash<qint64, QString>& unhashed) {
+    if (unhashed.isEmpty())
+      return;
+    const auto keys = unhashed.keys();
+    const auto lastID = *std::max_element(keys.cbegin(), keys.cend());
+    const bool more = unhashed.size() >= batchSize;
+    hashEvidenceFiles(unhashed).then(this, [this, lastID, more](const QHash<qint64, QString>& hashes) {
+      if (!hashes.isEmpty()) {
+        DatabaseWorker::get()->run([hashes](DatabaseConnection* conn) {
+          DBTransaction transaction(conn);
+          for (auto it = hashes.cbegin(); it != hashes.cend(); ++it)
+            conn->updateEvidenceContentHash(it.value(), it.key());
+          transaction.commit();
+        });
+      }
+      // the worker runs in order, so the next batch is read after these hashes are written
+      if (more)
+        hashEvidenceContent(lastID);
+    });
+  });
+}
+
+void TrayManager::indexCodeblockContent() {
+  DatabaseWorker::get()->run([](DatabaseConnection* conn) {
+    const auto unindexed = conn->getEvidencePathsWithoutContentText(Codeblock::contentType());
+    if (unindexed.isEmpty())
+      return;
+    DBTransaction transaction(conn);
+    for (auto it = unindexed.cbegin(); it != unindexed.cend(); ++it) {
+      auto content = Codeblock::readCodeblock(it.value()).content;
+      if (!content.isEmpty())
+        conn->updateEvidenceContentText(content, it.key());
+    }
+    transaction.commit();
+  });
 }
 
 void TrayManager::captureWindowActionTriggered() {
@@ -199,6 +357,8 @@ void TrayManager::captureWindowActionTriggered() {
     showNoOperationSetTrayMessage();
     return;
   }
+  NetMan::prewarmConnection();  // the evidence will likely be submitted shortly
+  TagCache::get()->prefetch(AppConfig::operationSlug());  // and tagged before that
   screenshotTool->captureWindow();
 }
 
@@ -207,6 +367,8 @@ void TrayManager::captureAreaActionTriggered() {
     showNoOperationSetTrayMessage();
     return;
   }
+  NetMan::prewarmConnection();  // the evidence will likely be submitted shortly
+  TagCache::get()->prefetch(AppConfig::operationSlug());  // and tagged before that
   screenshotTool->captureArea();
 }
 
@@ -215,6 +377,8 @@ void TrayManager::captureClipboardActionTriggered() {
     showNoOperationSetTrayMessage();
     return;
   }
+  NetMan::prewarmConnection();  // the evidence will likely be submitted shortly
+  TagCache::get()->prefetch(AppConfig::operationSlug());  // and tagged before that
   onClipboardCapture();
 }
 void TrayManager::onClipboardCapture()
@@ -222,6 +386,7 @@ void TrayManager::onClipboardCapture()
     const QMimeData *mimeData = QApplication::clipboard()->mimeData();
     QString path;
     QString type;
+    QString contentText;
     if (mimeData->hasHtml() || mimeData->hasText()) {
         QString clipboardContent = mimeData->text();
         if (clipboardContent.isEmpty())
@@ -234,6 +399,7 @@ void TrayManager::onClipboardCapture()
         }
         path = evidence.filePath();
         type = Codeblock::contentType();
+        contentText = evidence.content;
     } else if (mimeData->hasImage()) {
         path  = QDir::toNativeSeparators(SystemHelpers::pathToEvidence().append(Screenshot::mkName()));
         QImage img = qvariant_cast<QImage>(mimeData->imageData());
@@ -243,22 +409,16 @@ void TrayManager::onClipboardCapture()
         return;
     }
 
-    int evidenceID = createNewEvidence(path, type);
-    if(evidenceID == -1) {
-        showDBWriteErrorTrayMessage();
-        return;
-    }
-    spawnGetInfoWindow(evidenceID);
+    createNewEvidence(path, type, contentText).then(this, [this](const NewEvidence& created) {
+        onEvidenceCreated(created);
+    });
 }
 
 void TrayManager::onScreenshotCaptured(const QString& path)
 {
-  auto evidenceID = createNewEvidence(path, QStringLiteral("image"));
-  if(evidenceID == -1) {
-      showDBWriteErrorTrayMessage();
-      return;
-  }
-    spawnGetInfoWindow(evidenceID);
+  createNewEvidence(path, Screenshot::contentType()).then(this, [this](const NewEvidence& created) {
+    onEvidenceCreated(created);
+  });
 }
 
 void TrayManager::showDBWriteErrorTrayMessage()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QActionGroup>
+#include <QFuture>
 #include <QSystemTrayIcon>
 
 #include "db/databaseconnection.h"
@@ -54,7 +55,29 @@ class TrayManager : public QDialog {
  private:
   void buildUi();
   void wireUi();
-  qint64 createNewEvidence(const QString& filepath, const QString& evidenceType);
+  /// NewEvidence is the result of recording a capture (see createNewEvidence)
+  struct NewEvidence {
+    /// evidenceID is the new evidence, or -1 if the evidence could not be recorded
+    qint64 evidenceID = -1;
+    /// duplicateOfID is older evidence, in the same operation, with identical content (or 0)
+    qint64 duplicateOfID = 0;
+  };
+  /// createNewEvidence hashes the captured file (on the global thread pool), and then records the
+  /// evidence (and the last used tags) on the database worker. Once recorded, screenshots are moved into the content-addressed
+  /// store, if enabled. If any part of the write fails, nothing is recorded and the file stays put.
+  QFuture<NewEvidence> createNewEvidence(const QString& filepath, const QString& evidenceType,
+                                         const QString& contentText = QString());
+  /// onEvidenceCreated opens the GetInfo window for the new evidence, or reports a failed write
+  void onEvidenceCreated(const NewEvidence& created);
+  /// hashEvidenceContent records the content hash for evidence that was captured before hashing
+  /// existed. Evidence is hashed in batches (on the global thread pool), starting after
+  /// afterEvidenceID, and each batch's hashes are then written in one short transaction.
+  void hashEvidenceContent(qint64 afterEvidenceID = 0);
+  /// refreshEvidenceStats updates the tray's evidence counts for the current operation
+  void refreshEvidenceStats();
+  /// indexCodeblockContent records (on the database worker) the searchable text for codeblocks
+  /// that were captured before evidence search existed
+  void indexCodeblockContent();
   void spawnGetInfoWindow(qint64 evidenceID);
   void showNoOperationSetTrayMessage();
   void showDBWriteErrorTrayMessage();
@@ -110,6 +133,8 @@ class TrayManager : public QDialog {
   QSystemTrayIcon *trayIcon = nullptr;
   QMenu *chooseOpSubmenu = nullptr;
   QAction *newOperationAction = nullptr;
+  /// evidenceStatsAction displays (but does not act on) the evidence counts for the current operation
+  QAction *evidenceStatsAction = nullptr;
   QAction *selectedAction = nullptr;  // note: do not delete; for reference only
   QActionGroup allOperationActions;
 };
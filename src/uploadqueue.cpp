@@ -0,0 +1,219 @@
+#include "uploadqueue.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <QDateTime>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+
+#include "db/databaseworker.h"
+#include "helpers/http_status.h"
+#include "helpers/netman.h"
+
+UploadQueue::UploadQueue()
+{
+    _retryTimer.setSingleShot(true);
+    connect(&_retryTimer, &QTimer::timeout, this, &UploadQueue::sendDueUploads);
+}
+
+void UploadQueue::start()
+{
+    if (_running)
+        return;
+    _running = true;
+    DatabaseWorker::get()->run([](DatabaseConnection* conn) {
+        if (!conn->resetInterruptedUploads())
+            qWarning() << "Unable to requeue interrupted uploads: " << conn->errorString();
+    }).then(this, [this] {
+        sendDueUploads();
+    });
+}
+
+void UploadQueue::stop()
+{
+    _running = false;
+    _retryTimer.stop();
+    // anything prepared, but not sent, is requeued on the next start
+    for (const auto& ready : _ready)
+        NetMan::discardUpload(ready.prepared);
+    _ready.clear();
+}
+
+QFuture<QList<qint64>> UploadQueue::enqueue(const QList<qint64>& evidenceIDs)
+{
+    if (evidenceIDs.isEmpty())
+        return QtFuture::makeReadyValueFuture(QList<qint64>());
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    return DatabaseWorker::get()->run([evidenceIDs, now](DatabaseConnection* conn) {
+        QList<qint64> queued;
+        if (!conn->enqueueUploads(evidenceIDs, now, queued))
+            qWarning() << "Unable to queue evidence for upload: " << conn->errorString();
+        return queued;
+    }).then(this, [this](const QList<qint64>& queued) {
+        for (auto id : queued)
+            Q_EMIT uploadStateChanged(id, model::UploadState::QUEUED, QString());
+        sendDueUploads();
+        return queued;
+    });
+}
+
+void UploadQueue::sendDueUploads()
+{
+    if (!_running)
+        return;
+    if (_claiming) {
+        _claimAgain = true;
+        return;
+    }
+    const int freeSlots = maxParallelUploads + maxPreparedUploads - _claimed;
+    if (freeSlots <= 0)
+        return;  // claimed again as uploads complete
+
+    _claiming = true;
+    _claimAgain = false;
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    DatabaseWorker::get()->run([freeSlots, now](DatabaseConnection* conn) {
+        return conn->claimUploads(freeSlots, now);
+    }).then(this, [this, freeSlots](const QList<model::QueuedUpload>& claimed) {
+        _claiming = false;
+        if (!_running)
+            return;  // anything claimed is requeued on the next start
+        _claimed += claimed.size();
+        for (const auto& upload : claimed)
+            prepare(upload);
+        if (_claimAgain)
+            sendDueUploads();
+        else if (claimed.size() < freeSlots)
+            scheduleNextAttempt();
+    });
+}
+
+void UploadQueue::scheduleNextAttempt()
+{
+    DatabaseWorker::get()->run([](DatabaseConnection* conn) {
+        return conn->nextUploadAttemptAt();
+    }).then(this, [this](qint64 nextAttemptAt) {
+        if (!_running || nextAttemptAt < 0)
+            return;
+        auto wait = std::max<qint64>(0, nextAttemptAt - QDateTime::currentMSecsSinceEpoch());
+        _retryTimer.start(std::chrono::milliseconds(wait));
+    });
+}
+
+void UploadQueue::prepare(const model::QueuedUpload& upload)
+{
+    NetMan::prepareUpload(upload.evidence).then(this, [this, upload](const NetMan::PreparedUpload& prepared) {
+        if (!_running) {
+            NetMan::discardUpload(prepared);
+            return;
+        }
+        if (!prepared.errorText.isEmpty()) {
+            // nothing was sent, and trying again will not change that (e.g. the file is missing)
+            _claimed--;
+            failUpload(upload.evidence.id, tr("Unable to upload evidence: %1").arg(prepared.errorText));
+            sendDueUploads();
+            return;
+        }
+        _ready.append(ReadyUpload{upload, prepared});
+        sendReadyUploads();
+    });
+}
+
+void UploadQueue::sendReadyUploads()
+{
+    while (_running && _sending < maxParallelUploads && !_ready.isEmpty()) {
+        auto ready = _ready.takeFirst();
+        _sending++;
+        Q_EMIT uploadStateChanged(ready.upload.evidence.id, model::UploadState::UPLOADING, QString());
+        auto reply = NetMan::sendUpload(ready.prepared);
+        connect(reply, &QNetworkReply::finished, this, [this, reply, upload = ready.upload] {
+            onUploadComplete(reply, upload);
+        });
+    }
+}
+
+void UploadQueue::onUploadComplete(QNetworkReply* reply, const model::QueuedUpload& upload)
+{
+    // we don't need anything else from the reply, so just clean it up.
+    const bool uploaded = reply->error() == QNetworkReply::NoError;
+    const bool retryable = !uploaded && isRetryable(reply);
+    const auto errorText = uploaded ? QString() : describeFailure(reply);
+    reply->deleteLater();
+
+    _sending--;
+    _claimed--;
+    if (!_running)
+        return;
+
+    const auto id = upload.evidence.id;
+    if (uploaded) {
+        DatabaseWorker::get()->run([id](DatabaseConnection* conn) {
+            if (!conn->completeUpload(id))
+                qWarning() << "Upload successful. Could not update internal database. Error: " << conn->errorString();
+            return conn->getEvidenceDetails(id);
+        }).then(this, [this, id](const model::Evidence& evi) {
+            Q_EMIT uploadStateChanged(id, model::UploadState::DONE, QString());
+            if (evi.id != -1)
+                Q_EMIT evidenceSubmitted(evi);
+        });
+    }
+    else if (retryable && upload.attempt < maxAttempts) {
+        auto nextAttemptAt = QDateTime::currentMSecsSinceEpoch() + retryDelay(upload.attempt);
+        DatabaseWorker::get()->run([id, errorText, nextAttemptAt](DatabaseConnection* conn) {
+            if (!conn->retryUpload(id, errorText, nextAttemptAt))
+                qWarning() << "Upload failed. Could not update internal database. Error: " << conn->errorString();
+        }).then(this, [this, id, errorText] {
+            Q_EMIT uploadStateChanged(id, model::UploadState::QUEUED, errorText);
+            scheduleNextAttempt();
+        });
+    }
+    else {
+        failUpload(id, errorText);
+    }
+    sendReadyUploads();
+    sendDueUploads();
+}
+
+void UploadQueue::failUpload(qint64 evidenceID, const QString& errorText)
+{
+    DatabaseWorker::get()->run([evidenceID, errorText](DatabaseConnection* conn) {
+        if (!conn->failUpload(evidenceID, errorText))
+            qWarning() << "Upload failed. Could not update internal database. Error: " << conn->errorString();
+    }).then(this, [this, evidenceID, errorText] {
+        Q_EMIT uploadStateChanged(evidenceID, model::UploadState::FAILED, errorText);
+    });
+}
+
+QString UploadQueue::describeFailure(QNetworkReply* reply)
+{
+    bool hasStatus = false;
+    auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(&hasStatus);
+    if (!hasStatus)
+        return tr("Unable to upload evidence: Network error (%1)").arg(reply->errorString());
+    auto reason = reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toString();
+    if (reason.isEmpty())
+        return tr("Unable to upload evidence: The server responded with HTTP %1").arg(status);
+    return tr("Unable to upload evidence: The server responded with HTTP %1 (%2)")
+        .arg(QString::number(status), reason);
+}
+
+bool UploadQueue::isRetryable(QNetworkReply* reply)
+{
+    bool hasStatus = false;
+    auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(&hasStatus);
+    if (!hasStatus)
+        return true;  // never reached the server (or lost the connection): worth another try
+    return status == HttpStatus::StatusRequestTimeout
+        || status == HttpStatus::StatusTooManyRequests
+        || status >= HttpStatus::StatusInternalServerError;
+}
+
+qint64 UploadQueue::retryDelay(int attempt)
+{
+    constexpr qint64 baseDelay = 2000;
+    constexpr qint64 maxDelay = 5 * 60 * 1000;
+    const auto delay = std::min(maxDelay, baseDelay << std::clamp(attempt - 1, 0, 16));
+    // wait between half and all of the delay
+    return delay / 2 + QRandomGenerator::global()->bounded(delay / 2 + 1);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QFuture>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+#include "helpers/netman.h"
+#include "models/evidence.h"
+#include "models/upload.h"
+
+/**
+ * @brief The UploadQueue class submits evidence in the background. The queue itself is kept in the
+ * database (see the upload_queue table), so anything not yet uploaded is picked up again on the
+ * next start.
+ *
+ * Up to maxParallelUploads uploads are in flight at once. Uploads are pipelined: while those are
+ * being sent, up to maxPreparedUploads more are read from the database, encoded and hashed, so
+ * that each can be sent as soon as a slot frees up. Attempts that fail in a way that may pass
+ * later (network errors, server errors, rate limiting) are retried after an exponential, jittered,
+ * backoff, up to maxAttempts times. Other failures (and the final retry) mark the evidence as failed.
+ *
+ * All database work is done on the DatabaseWorker, and all signals are emitted on the GUI thread.
+ */
+class UploadQueue : public QObject {
+  Q_OBJECT
+
+ public:
+  static UploadQueue* get() {
+    static UploadQueue instance;
+    return &instance;
+  }
+
+  /// maxParallelUploads is the number of uploads sent at the same time
+  inline static constexpr int maxParallelUploads = 4;
+  /// maxPreparedUploads is the number of uploads made ready ahead of a free slot
+  inline static constexpr int maxPreparedUploads = 2;
+  /// maxAttempts is the number of times an upload is tried before it is marked as failed
+  inline static constexpr int maxAttempts = 6;
+
+  /// start resumes the queue: uploads interrupted by the previous exit are requeued, and anything
+  /// that is due is sent
+  void start();
+  /// stop sends no further uploads. Uploads still in flight are ignored, and are requeued on the
+  /// next start. Call this before the DatabaseWorker is shut down.
+  void stop();
+  /// enqueue adds evidence to the queue, and starts sending it. Submitted evidence (and evidence
+  /// already being uploaded) is skipped, and evidence that had failed is retried from scratch.
+  /// Returns a future for the evidence that was actually queued; only these report their progress
+  /// through uploadStateChanged.
+  QFuture<QList<qint64>> enqueue(const QList<qint64>& evidenceIDs);
+
+ signals:
+  /**
+   * @brief uploadStateChanged is emitted as evidence moves through the queue
+   * @param evidenceID The evidence being uploaded
+   * @param state The new state. A failed attempt that will be retried goes back to QUEUED.
+   * @param errorText The reason the last attempt failed, if it did
+   */
+  void uploadStateChanged(qint64 evidenceID, model::UploadState state, const QString& errorText);
+  /// evidenceSubmitted is emitted once evidence has been uploaded, and recorded as such
+  void evidenceSubmitted(const model::Evidence& evidence);
+
+ private:
+  UploadQueue();
+  ~UploadQueue() = default;
+  UploadQueue(UploadQueue const&) = delete;
+  void operator=(UploadQueue const&) = delete;
+
+  /// ReadyUpload is a claimed upload that has been prepared, and is waiting for a free slot
+  struct ReadyUpload {
+    model::QueuedUpload upload;
+    NetMan::PreparedUpload prepared;
+  };
+
+  /// sendDueUploads claims as many due uploads as can be sent or prepared, and prepares them
+  void sendDueUploads();
+  /// scheduleNextAttempt arms the retry timer for the next queued upload, if any
+  void scheduleNextAttempt();
+  /// prepare encodes and hashes a claimed upload (off of the GUI thread), then queues it to be sent
+  void prepare(const model::QueuedUpload& upload);
+  /// sendReadyUploads sends prepared uploads while there are free slots
+  void sendReadyUploads();
+  void onUploadComplete(QNetworkReply* reply, const model::QueuedUpload& upload);
+  /// failUpload gives up on an upload, recording errorText, and reports it as FAILED
+  void failUpload(qint64 evidenceID, const QString& errorText);
+
+  /// describeFailure explains why an upload failed: either a network error, or the server's response
+  static QString describeFailure(QNetworkReply* reply);
+
+  /// isRetryable returns true if a failed upload may succeed if tried again later
+  static bool isRetryable(QNetworkReply* reply);
+  /// retryDelay returns how long to wait (in ms) before the next attempt, after the given attempt
+  /// failed. The delay doubles with each attempt, and is randomized so that uploads that failed
+  /// together are not all retried together.
+  static qint64 retryDelay(int attempt);
+
+  bool _running = false;
+  /// _claiming is true while a claim is outstanding on the database worker
+  bool _claiming = false;
+  /// _claimAgain records a request to send uploads that arrived while claiming
+  bool _claimAgain = false;
+  /// _claimed counts the claimed uploads (being prepared, ready, or sent) that have not yet completed
+  int _claimed = 0;
+  /// _sending counts the uploads that have been sent, and not yet completed
+  int _sending = 0;
+  QList<ReadyUpload> _ready;
+  QTimer _retryTimer;
+};
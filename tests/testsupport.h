@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTimeZone>
+#include <QtTest>
+
+#include "db/databaseconnection.h"
+
+/**
+ * @brief TestDatabase opens a freshly migrated evidence database for a test. The database is in
+ * memory, unless a path is given, in which case it is a file in WAL mode (as in the application).
+ * Open it in initTestCase, and close it (by resetting the owning pointer) in cleanupTestCase.
+ * Each TestDatabase needs its own connectionName.
+ */
+class TestDatabase {
+ public:
+  explicit TestDatabase(const QString &connectionName, const QString &path = QString())
+      : _connectionName(connectionName) {
+    // the migrations live in the (static) DB library, so their resources must be pulled in
+    Q_INIT_RESOURCE(res_migrations);
+    _db = std::make_unique<DatabaseConnection>(path.isEmpty() ? QStringLiteral(":memory:") : path,
+                                               connectionName);
+    _open = _db->connect() && (path.isEmpty() || _db->useWriteAheadLog());
+  }
+  ~TestDatabase() { _db->close(); }
+  TestDatabase(const TestDatabase &) = delete;
+  TestDatabase &operator=(const TestDatabase &) = delete;
+
+  /// isOpen is true if the database was opened (and migrated). See errorString otherwise.
+  [[nodiscard]] bool isOpen() const { return _open; }
+  [[nodiscard]] QString errorString() const { return _db->errorString(); }
+
+  DatabaseConnection *get() const { return _db.get(); }
+
+  /// query returns a query on this database's connection, for checks the DatabaseConnection
+  /// interface does not offer
+  [[nodiscard]] QSqlQuery query() const {
+    return QSqlQuery(QSqlDatabase::database(_connectionName));
+  }
+
+  /// count returns the number of rows in table, or -1 if it cannot be read
+  [[nodiscard]] qint64 count(const QString &table) const {
+    auto q = query();
+    if (!q.exec(QStringLiteral("SELECT COUNT(*) FROM %1").arg(table)) || !q.next())
+      return -1;
+    return q.value(0).toLongLong();
+  }
+
+ private:
+  QString _connectionName;
+  std::unique_ptr<DatabaseConnection> _db;
+  bool _open = false;
+};
+
+/**
+ * @brief TestData generates the (deterministic) evidence and tags used by the tests and
+ * benchmarks. Evidence i (0-based) has the id i + 1, and:
+ *   - belongs to operation "op-<i % operationCount>"
+ *   - is a codeblock when i % 3 == 0 (with contentText), and an image otherwise
+ *   - has an error when i % 10 == 0, and has been uploaded when i % 2 == 0
+ *   - was recorded i minutes after 2024-01-01 (UTC)
+ */
+class TestData {
+ public:
+  inline static const int operationCount = 5;
+
+  static QString operationSlug(int i) { return QStringLiteral("op-%1").arg(i % operationCount); }
+  static QString tagName(int tag) { return QStringLiteral("tag-%1").arg(tag); }
+
+  static QList<model::Evidence> evidence(int count) {
+    QList<model::Evidence> rtn;
+    rtn.reserve(count);
+    const auto start = QDateTime(QDate(2024, 1, 1), QTime(0, 0), QTimeZone::UTC);
+    for (int i = 0; i < count; i++) {
+      model::Evidence item;
+      item.id = i + 1;
+      item.operationSlug = operationSlug(i);
+      const bool codeblock = i % 3 == 0;
+      item.contentType = codeblock ? QStringLiteral("codeblock") : QStringLiteral("image");
+      item.path = QStringLiteral("/evidence/%1/ashirt_%2.%3")
+                      .arg(item.operationSlug)
+                      .arg(i)
+                      .arg(codeblock ? QStringLiteral("json") : QStringLiteral("png"));
+      item.description = QStringLiteral("Login page for host %1, with default credentials").arg(i);
+      if (codeblock)
+        item.contentText = QStringLiteral("SELECT * FROM accounts WHERE host_%1 = 'admin'").arg(i);
+      if (i % 10 == 0)
+        item.errorText = QStringLiteral("Unable to upload");
+      item.recordedDate = start.addSecs(i * 60LL);
+      if (i % 2 == 0)
+        item.uploadDate = item.recordedDate.addSecs(3600);
+      item.contentHash = QStringLiteral("%1").arg(i, 64, 16, QLatin1Char('0'));
+      rtn.append(item);
+    }
+    return rtn;
+  }
+
+  /// tagIndex is the k-th tag (0-based, of distinctTags) carried by evidence i. The tags of each
+  /// evidence are spread apart, so that no two tags always appear together.
+  static int tagIndex(int i, int k, int distinctTags) { return (i * 7 + k * 131) % distinctTags; }
+
+  /// tags gives each of evidence tagsPerEvidence tags (see tagIndex), named with tagName
+  static QList<model::Tag> tags(const QList<model::Evidence> &evidence, int tagsPerEvidence,
+                                int distinctTags) {
+    QList<model::Tag> rtn;
+    rtn.reserve(evidence.size() * tagsPerEvidence);
+    for (int i = 0; i < evidence.size(); i++) {
+      for (int k = 0; k < tagsPerEvidence; k++) {
+        const int tag = tagIndex(i, k, distinctTags);
+        rtn.append(model::Tag(rtn.size() + 1, evidence.at(i).id, tag + 1, tagName(tag)));
+      }
+    }
+    return rtn;
+  }
+};
+
+/**
+ * @brief TestTiming holds the measuring shared by the benchmarks. Performance targets are reported
+ * as warnings, rather than failures, so that the tests do not depend on the speed of the machine
+ * running them. The figures to compare over time come from QBENCHMARK.
+ */
+class TestTiming {
+ public:
+  /// bestOfThreeNs runs action three times, returning the fastest run, so that a single hiccup on
+  /// a busy machine does not skew the result
+  static qint64 bestOfThreeNs(const std::function<void()> &action) {
+    qint64 best = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < 3; i++) {
+      QElapsedTimer timer;
+      timer.start();
+      action();
+      best = std::min(best, timer.nsecsElapsed());
+    }
+    return best;
+  }
+
+  /// reportTarget warns if tookNs missed the target (targetNs) for what was measured
+  static void reportTarget(const QString &what, qint64 tookNs, qint64 targetNs) {
+    if (tookNs < targetNs)
+      return;
+    qWarning().noquote() << QStringLiteral("%1 missed its target: took %2us (target: under %3us)")
+                                .arg(what)
+                                .arg(tookNs / 1000)
+                                .arg(targetNs / 1000);
+  }
+};
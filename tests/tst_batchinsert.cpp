@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <limits>
+
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "db/dbtransaction.h"
+#include "testsupport.h"
+
+/**
+ * @brief tst_BatchInsert compares the two bulk insert backends of DatabaseConnection: batchInsert,
+ * which sends frames of "VALUES (?, ?, ?), (?, ?, ?), ..." (at most SQLITE_MAX_VARS values each),
+ * and batchInsertColumns, which binds each column once and steps a single row statement through
+ * them with execBatch. Both run inside one transaction, as the bulk copies do.
+ */
+class tst_BatchInsert : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void insertTags_data();
+  void insertTags();
+
+ private:
+  inline static const int insertRounds = 5;
+  QTemporaryDir _dir;
+  std::unique_ptr<TestDatabase> _db;
+};
+
+void tst_BatchInsert::initTestCase() {
+  QVERIFY(_dir.isValid());
+  // a file (in WAL mode), rather than :memory:, so that commits pay for their syncs as they do
+  // in the application
+  _db = std::make_unique<TestDatabase>(QStringLiteral("tst_batchinsert"),
+                                       _dir.filePath(QStringLiteral("bench.sqlite")));
+  QVERIFY2(_db->isOpen(), qPrintable(_db->errorString()));
+}
+
+void tst_BatchInsert::cleanupTestCase() {
+  _db.reset();
+}
+
+void tst_BatchInsert::insertTags_data() {
+  QTest::addColumn<int>("rows");
+  QTest::addColumn<bool>("execBatch");
+
+  for (int rows : {1000, 10000, 100000}) {
+    const auto size = QStringLiteral("%1k").arg(rows / 1000);
+    QTest::newRow(qPrintable(QStringLiteral("VALUES string, ") + size)) << rows << false;
+    QTest::newRow(qPrintable(QStringLiteral("execBatch, ") + size)) << rows << true;
+  }
+}
+
+void tst_BatchInsert::insertTags() {
+  QFETCH(int, rows);
+  QFETCH(bool, execBatch);
+
+  QList<QVariantList> columns(3);
+  for (auto &column : columns)
+    column.reserve(rows);
+  for (int i = 0; i < rows; i++) {
+    columns[0].append(i / 4 + 1);
+    columns[1].append(i % 50 + 1);
+    columns[2].append(QStringLiteral("tag-%1").arg(i % 50));
+  }
+  auto encodeValues = [&columns](unsigned int i) {
+    return QVariantList{columns[0].at(i), columns[1].at(i), columns[2].at(i)};
+  };
+
+  auto insert = [&]() {
+    if (execBatch) {
+      return _db->get()->batchInsertColumns(
+          QStringLiteral("INSERT INTO tags (evidence_id, tag_id, name) VALUES (?, ?, ?)"), columns);
+    }
+    DBTransaction transaction(_db->get());
+    bool inserted = _db->get()->batchInsert(
+        QStringLiteral("INSERT INTO tags (evidence_id, tag_id, name) VALUES %1"), 3, rows,
+        encodeValues);
+    return inserted && transaction.commit();
+  };
+
+  // each round starts from the same (empty) table. The rows are removed outside of the timed part,
+  // so only the insert is measured; the fastest round is reported as the benchmark result.
+  auto clear = _db->query();
+  qint64 bestNs = std::numeric_limits<qint64>::max();
+  for (int round = 0; round < insertRounds; round++) {
+    QVERIFY(clear.exec(QStringLiteral("DELETE FROM tags")));
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(insert());
+    bestNs = std::min(bestNs, timer.nsecsElapsed());
+    QCOMPARE(_db->count(QStringLiteral("tags")), qint64(rows));
+  }
+  QTest::setBenchmarkResult(bestNs, QTest::WalltimeNanoseconds);
+}
+
+QTEST_GUILESS_MAIN(tst_BatchInsert)
+#include "tst_batchinsert.moc"
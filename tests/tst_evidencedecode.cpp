@@ -0,0 +1,105 @@
+#include <QtTest>
+
+#include "testsupport.h"
+
+/**
+ * @brief tst_EvidenceDecode compares decoding evidence rows with EvidenceMapper (by column index)
+ * against the by-name decoding it replaced, where each value was looked up with
+ * query.value("column"). Both read the same (forward only) query.
+ */
+class tst_EvidenceDecode : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void decodersAgree();
+  void decodeAll_data();
+  void decodeAll();
+
+ private:
+  /// decodeByName is the decoding EvidenceMapper replaced, kept here as the baseline
+  static model::Evidence decodeByName(const QSqlQuery &query);
+  QList<model::Evidence> readAll(bool byName);
+
+  inline static const int evidenceCount = 20000;
+  std::unique_ptr<TestDatabase> _db;
+};
+
+void tst_EvidenceDecode::initTestCase() {
+  _db = std::make_unique<TestDatabase>(QStringLiteral("tst_evidencedecode"));
+  QVERIFY2(_db->isOpen(), qPrintable(_db->errorString()));
+  QVERIFY2(_db->get()->batchCopyFullEvidence(TestData::evidence(evidenceCount)),
+           qPrintable(_db->errorString()));
+}
+
+void tst_EvidenceDecode::cleanupTestCase() {
+  _db.reset();
+}
+
+void tst_EvidenceDecode::decodersAgree() {
+  const auto byName = readAll(true);
+  const auto mapped = readAll(false);
+  QCOMPARE(mapped.size(), qsizetype(evidenceCount));
+  QCOMPARE(byName.size(), mapped.size());
+  for (int i = 0; i < mapped.size(); i++) {
+    const auto &a = byName.at(i);
+    const auto &b = mapped.at(i);
+    QCOMPARE(b.id, a.id);
+    QCOMPARE(b.path, a.path);
+    QCOMPARE(b.operationSlug, a.operationSlug);
+    QCOMPARE(b.contentType, a.contentType);
+    QCOMPARE(b.description, a.description);
+    QCOMPARE(b.errorText, a.errorText);
+    QCOMPARE(b.recordedDate, a.recordedDate);
+    QCOMPARE(b.uploadDate, a.uploadDate);
+    QCOMPARE(b.contentHash, a.contentHash);
+  }
+}
+
+void tst_EvidenceDecode::decodeAll_data() {
+  QTest::addColumn<bool>("byName");
+  QTest::newRow("by name") << true;
+  QTest::newRow("row mapper") << false;
+}
+
+void tst_EvidenceDecode::decodeAll() {
+  QFETCH(bool, byName);
+  QBENCHMARK {
+    auto all = readAll(byName);
+    QCOMPARE(all.size(), qsizetype(evidenceCount));
+  }
+}
+
+QList<model::Evidence> tst_EvidenceDecode::readAll(bool byName) {
+  QList<model::Evidence> rtn;
+  auto query = _db->query();
+  // both decoders read the same forward only query, so that only the decoding differs
+  query.setForwardOnly(true);
+  if (!query.exec(QStringLiteral("SELECT %1 FROM evidence").arg(EvidenceMapper::columnList()))) {
+    qWarning() << "Unable to read evidence: " << query.lastError().text();
+    return rtn;
+  }
+  while (query.next())
+    rtn.append(byName ? decodeByName(query) : EvidenceMapper::read(query));
+  return rtn;
+}
+
+model::Evidence tst_EvidenceDecode::decodeByName(const QSqlQuery &query) {
+  model::Evidence evi;
+  evi.id = query.value(QStringLiteral("id")).toLongLong();
+  evi.path = query.value(QStringLiteral("path")).toString();
+  evi.operationSlug = query.value(QStringLiteral("operation_slug")).toString();
+  evi.contentType = query.value(QStringLiteral("content_type")).toString();
+  evi.description = query.value(QStringLiteral("description")).toString();
+  evi.errorText = query.value(QStringLiteral("error")).toString();
+  evi.recordedDate = query.value(QStringLiteral("recorded_date")).toDateTime();
+  evi.uploadDate = query.value(QStringLiteral("upload_date")).toDateTime();
+  evi.contentHash = query.value(QStringLiteral("content_hash")).toString();
+  evi.recordedDate.setTimeZone(QTimeZone::UTC);
+  evi.uploadDate.setTimeZone(QTimeZone::UTC);
+  return evi;
+}
+
+QTEST_GUILESS_MAIN(tst_EvidenceDecode)
+#include "tst_evidencedecode.moc"
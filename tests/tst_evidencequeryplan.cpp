@@ -0,0 +1,200 @@
+#include <QRegularExpression>
+#include <QtTest>
+
+#include "testsupport.h"
+
+Q_DECLARE_METATYPE(EvidenceFilters)
+
+/**
+ * @brief tst_EvidenceQueryPlan checks, via EXPLAIN QUERY PLAN, that every evidence filter
+ * combination which narrows the results is answered from an index, rather than by reading all of
+ * the evidence (or tags) table. Filters that narrow nothing (e.g. only excluded tags) have to look
+ * at every evidence row anyway; their plans are compared against the one expected scan.
+ */
+class tst_EvidenceQueryPlan : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void filtersUseIndexes_data();
+  void filtersUseIndexes();
+
+ private:
+  QStringList queryPlan(DBQuery dbQuery, QString *error);
+  /// unselectivePlan is the expected plan (its SCAN and SEARCH steps) for filters that narrow
+  /// nothing
+  static QStringList unselectivePlan(const EvidenceFilters &filters, bool includeTags, bool paged);
+
+  std::unique_ptr<TestDatabase> _db;
+  /// _partialIndexes holds the indexes that only cover some rows (and so may be scanned)
+  QStringList _partialIndexes;
+};
+
+void tst_EvidenceQueryPlan::initTestCase() {
+  _db = std::make_unique<TestDatabase>(QStringLiteral("tst_evidencequeryplan"));
+  QVERIFY2(_db->isOpen(), qPrintable(_db->errorString()));
+
+  auto indexes = _db->query();
+  for (const auto &table : {QStringLiteral("evidence"), QStringLiteral("tags")}) {
+    QVERIFY(indexes.exec(QStringLiteral("PRAGMA index_list(%1)").arg(table)));
+    while (indexes.next()) {
+      if (indexes.value(QStringLiteral("partial")).toBool())
+        _partialIndexes.append(indexes.value(QStringLiteral("name")).toString());
+    }
+  }
+}
+
+void tst_EvidenceQueryPlan::cleanupTestCase() {
+  _db.reset();
+}
+
+void tst_EvidenceQueryPlan::filtersUseIndexes_data() {
+  QTest::addColumn<EvidenceFilters>("filters");
+  QTest::addColumn<bool>("includeTags");
+  QTest::addColumn<bool>("paged");
+  QTest::addColumn<bool>("selective");
+
+  const QList<Tri> tris = {Tri::Any, Tri::Yes, Tri::No};
+  const QList<QList<QStringList>> tagGroups = {
+      {},
+      {{QStringLiteral("alpha")}},
+      {{QStringLiteral("alpha"), QStringLiteral("beta")}, {QStringLiteral("gamma")}},
+  };
+
+  for (int mask = 0; mask < (1 << 6); mask++) {
+    for (Tri hasError : tris) {
+      for (Tri submitted : tris) {
+        for (const auto &tags : tagGroups) {
+          EvidenceFilters filters;
+          QStringList name;
+          if (mask & 0x01) {
+            filters.operationSlug = QStringLiteral("op");
+            name.append(QStringLiteral("op"));
+          }
+          if (mask & 0x02) {
+            filters.contentType = QStringLiteral("image");
+            name.append(QStringLiteral("type"));
+          }
+          if (mask & 0x04) {
+            filters.startDate = QDate(2020, 1, 1);
+            name.append(QStringLiteral("from"));
+          }
+          if (mask & 0x08) {
+            filters.endDate = QDate(2020, 2, 1);
+            name.append(QStringLiteral("to"));
+          }
+          if (mask & 0x10) {
+            filters.text = QStringLiteral("password");
+            name.append(QStringLiteral("text"));
+          }
+          if (mask & 0x20) {
+            filters.excludedTags = {QStringLiteral("delta")};
+            name.append(QStringLiteral("-tag"));
+          }
+          if (!tags.isEmpty()) {
+            filters.tags = tags;
+            name.append(QStringLiteral("tag*%1").arg(tags.size()));
+          }
+          filters.hasError = hasError;
+          if (hasError != Tri::Any)
+            name.append(QStringLiteral("err=") + EvidenceFilters::triToString(hasError));
+          filters.submitted = submitted;
+          if (submitted != Tri::Any)
+            name.append(QStringLiteral("submitted=") + EvidenceFilters::triToString(submitted));
+
+          bool selective = (mask & 0x1F) || !tags.isEmpty()
+                           || hasError == Tri::Yes || submitted == Tri::No;
+
+          for (bool includeTags : {false, true}) {
+            for (bool paged : {false, true}) {
+              auto rowName = name.isEmpty() ? QStringLiteral("(none)")
+                                            : name.join(QLatin1Char(' '));
+              if (includeTags)
+                rowName.append(QStringLiteral(" [with tags]"));
+              if (paged)
+                rowName.append(QStringLiteral(" [paged]"));
+              QTest::newRow(qPrintable(rowName)) << filters << includeTags << paged << selective;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+void tst_EvidenceQueryPlan::filtersUseIndexes() {
+  QFETCH(EvidenceFilters, filters);
+  QFETCH(bool, includeTags);
+  QFETCH(bool, paged);
+  QFETCH(bool, selective);
+
+  // mirrors the query EvidenceCursor builds for every page after the first
+  auto dbQuery = paged
+      ? DatabaseConnection::buildEvidenceQuery(
+            filters, includeTags, {QStringLiteral(" (recorded_date, id) > (?, ?) ")},
+            {QDateTime(QDate(2020, 1, 15), QTime(12, 0)), 42},
+            QStringLiteral(" ORDER BY recorded_date, id LIMIT 500"))
+      : DatabaseConnection::buildEvidenceQuery(filters, includeTags);
+
+  QString error;
+  const auto plan = queryPlan(dbQuery, &error);
+  QVERIFY2(error.isEmpty(), qPrintable(error));
+  QVERIFY(!plan.isEmpty());
+
+  if (!selective) {
+    QStringList steps;
+    for (const auto &line : plan) {
+      if (line.startsWith(QStringLiteral("SCAN ")) || line.startsWith(QStringLiteral("SEARCH ")))
+        steps.append(line);
+    }
+    QCOMPARE(steps, unselectivePlan(filters, includeTags, paged));
+    return;
+  }
+
+  static const QRegularExpression fullScan(
+      QStringLiteral("^SCAN (evidence|tags)\\b(?: USING (?:COVERING )?INDEX (\\w+))?"));
+  for (const auto &line : plan) {
+    auto match = fullScan.match(line);
+    if (!match.hasMatch() || _partialIndexes.contains(match.captured(2)))
+      continue;
+    QFAIL(qPrintable(QStringLiteral("full table scan: \"%1\"\nplan:\n  %2\nquery: %3")
+                         .arg(line, plan.join(QStringLiteral("\n  ")), dbQuery.query())));
+  }
+}
+
+QStringList tst_EvidenceQueryPlan::queryPlan(DBQuery dbQuery, QString *error) {
+  auto query = _db->query();
+  const auto values = dbQuery.values();
+  bool success = query.prepare(QStringLiteral("EXPLAIN QUERY PLAN ") + dbQuery.query());
+  for (int i = 0; success && i < values.size(); i++)
+    query.bindValue(i, values.at(i));
+  if (!success || !query.exec()) {
+    *error = query.lastError().text();
+    return {};
+  }
+
+  QStringList plan;
+  while (query.next())
+    plan.append(query.value(QStringLiteral("detail")).toString());
+  return plan;
+}
+
+QStringList tst_EvidenceQueryPlan::unselectivePlan(const EvidenceFilters &filters,
+                                                   bool includeTags, bool paged) {
+  QStringList plan;
+  // every evidence row is read, in recorded order when paged (the keyset condition narrows it)
+  plan.append(paged ? QStringLiteral("SEARCH evidence USING INDEX idx_evidence_recorded_date"
+                                     " (recorded_date>?)")
+                    : QStringLiteral("SCAN evidence"));
+  // excluded tags are looked up once, by name, rather than per evidence row
+  if (!filters.excludedTags.isEmpty())
+    plan.append(QStringLiteral("SEARCH tags USING COVERING INDEX idx_tags_name (name=?)"));
+  if (includeTags)
+    plan.append(
+        QStringLiteral("SEARCH tags USING COVERING INDEX idx_tags_evidence_id (evidence_id=?)"));
+  return plan;
+}
+
+QTEST_GUILESS_MAIN(tst_EvidenceQueryPlan)
+#include "tst_evidencequeryplan.moc"
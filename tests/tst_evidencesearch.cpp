@@ -0,0 +1,103 @@
+#include <algorithm>
+
+#include <QtTest>
+
+#include "testsupport.h"
+
+/**
+ * @brief tst_EvidenceSearch checks text: searches (over evidence descriptions and content) against
+ * 100k evidence: the evidence found must be exactly the evidence expected from the generated data.
+ * Each search is then benchmarked, against a target of under 50ms. It also checks that the content
+ * text is only read on request.
+ */
+class tst_EvidenceSearch : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void contentTextOnRequest();
+  void search_data();
+  void search();
+
+ private:
+  inline static const int evidenceCount = 100000;
+  inline static const qint64 maxSearchMs = 50;
+  std::unique_ptr<TestDatabase> _db;
+};
+
+void tst_EvidenceSearch::initTestCase() {
+  _db = std::make_unique<TestDatabase>(QStringLiteral("tst_evidencesearch"));
+  QVERIFY2(_db->isOpen(), qPrintable(_db->errorString()));
+  QVERIFY2(_db->get()->batchCopyFullEvidence(TestData::evidence(evidenceCount)),
+           qPrintable(_db->errorString()));
+}
+
+void tst_EvidenceSearch::cleanupTestCase() {
+  _db.reset();
+}
+
+void tst_EvidenceSearch::contentTextOnRequest() {
+  const QList<qint64> ids = {1, 2, 4};
+  for (const auto &evi : _db->get()->getEvidenceDetails(ids))
+    QVERIFY(evi.contentText.isEmpty());
+
+  // evidence 1 and 4 (i = 0 and 3) are codeblocks; evidence 2 is an image, without text
+  const auto generated = TestData::evidence(4);
+  const auto contentText = _db->get()->getEvidenceContentText(ids);
+  QCOMPARE(contentText.size(), ids.size());
+  QCOMPARE(contentText.value(1), generated.at(0).contentText);
+  QCOMPARE(contentText.value(2), QString());
+  QCOMPARE(contentText.value(4), generated.at(3).contentText);
+}
+
+void tst_EvidenceSearch::search_data() {
+  QTest::addColumn<QString>("text");
+  QTest::addColumn<QList<qint64>>("expected");
+
+  // descriptions hold "host <i>", and codeblock content "host_<i> = 'admin'". Words are matched
+  // as prefixes, so "9999" also finds hosts 99990 to 99999.
+  QList<qint64> rare;
+  QList<qint64> common;
+  QList<qint64> twoWords;
+  for (int i = 0; i < evidenceCount; i++) {
+    const auto host = QString::number(i);
+    if (host.startsWith(QStringLiteral("9999")))
+      rare.append(i + 1);
+    if (i % 3 == 0)
+      common.append(i + 1);
+    if (host.startsWith(QStringLiteral("4242")))
+      twoWords.append(i + 1);
+  }
+  QTest::newRow("rare word") << QStringLiteral("9999") << rare;
+  QTest::newRow("content word") << QStringLiteral("admin") << common;
+  QTest::newRow("two words") << QStringLiteral("default 4242") << twoWords;
+  QTest::newRow("no match") << QStringLiteral("zzzz") << QList<qint64>();
+}
+
+void tst_EvidenceSearch::search() {
+  QFETCH(QString, text);
+  QFETCH(QList<qint64>, expected);
+
+  EvidenceFilters filters;
+  filters.text = text;
+  auto run = [&]() { return _db->get()->getEvidenceWithFilters(filters); };
+
+  const auto found = run();
+  QList<qint64> foundIDs;
+  foundIDs.reserve(found.size());
+  for (const auto &evi : found)
+    foundIDs.append(evi.id);
+  std::sort(foundIDs.begin(), foundIDs.end());
+  QCOMPARE(foundIDs, expected);
+
+  TestTiming::reportTarget(QString::fromLatin1(QTest::currentDataTag()),
+                           TestTiming::bestOfThreeNs([&run] { run(); }), maxSearchMs * 1000000);
+  QBENCHMARK {
+    auto results = run();
+    Q_UNUSED(results);
+  }
+}
+
+QTEST_GUILESS_MAIN(tst_EvidenceSearch)
+#include "tst_evidencesearch.moc"
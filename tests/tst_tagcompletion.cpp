@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <limits>
+
+#include <QElapsedTimer>
+#include <QtTest>
+
+#include "components/tagging/tagcompletionmodel.h"
+#include "testsupport.h"
+
+/**
+ * @brief tst_TagCompletion checks the order TagCompletionModel ranks its matches in, on small
+ * fixed sets of tags, then times setFilter while a query is typed, one character at a time,
+ * against 20k tags. Keystrokes answered in over 1ms (in release builds) are reported as warnings.
+ */
+class tst_TagCompletion : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void ranking_data();
+  void ranking();
+  void typeQuery_data();
+  void typeQuery();
+
+ private:
+  inline static const int tagCount = 20000;
+  inline static const qint64 maxKeystrokeNs = 1000000;
+  QStringList _tags;
+};
+
+void tst_TagCompletion::initTestCase() {
+  const QStringList words = {
+      QStringLiteral("web"),      QStringLiteral("database"), QStringLiteral("admin"),
+      QStringLiteral("login"),    QStringLiteral("password"), QStringLiteral("sql"),
+      QStringLiteral("xss"),      QStringLiteral("injection"), QStringLiteral("server"),
+      QStringLiteral("internal"), QStringLiteral("external"), QStringLiteral("critical"),
+      QStringLiteral("review"),   QStringLiteral("confirmed"), QStringLiteral("network"),
+      QStringLiteral("api"),      QStringLiteral("token"),    QStringLiteral("session"),
+      QStringLiteral("cloud"),    QStringLiteral("bucket"),
+  };
+  _tags.reserve(tagCount);
+  for (int i = 0; _tags.size() < tagCount; i++) {
+    const auto &first = words.at(i % words.size());
+    const auto &second = words.at((i / words.size()) % words.size());
+    _tags.append(QStringLiteral("%1-%2-%3").arg(first, second).arg(i));
+  }
+}
+
+void tst_TagCompletion::ranking_data() {
+  // usage is shared by every model, so each row uses names of its own
+  QTest::addColumn<QStringList>("tags");
+  QTest::addColumn<QStringList>("used");
+  QTest::addColumn<QString>("query");
+  QTest::addColumn<QStringList>("expected");
+
+  QTest::newRow("tiers") << QStringList{"relogin", "loggin", "admin-login", "unrelated",
+                                        "login-page"}
+                         << QStringList() << QStringLiteral("login")
+                         << QStringList{"login-page", "admin-login", "relogin", "loggin"};
+  QTest::newRow("tier before usage")
+      << QStringList{"cobweb", "web-app", "scan-web"}
+      << QStringList{"cobweb", "cobweb", "scan-web"} << QStringLiteral("Web")
+      << QStringList{"web-app", "scan-web", "cobweb"};
+  QTest::newRow("usage within a tier")
+      << QStringList{"sql-a", "sql-b", "sql-c", "sql-d", "nosql"}
+      << QStringList{"nosql", "nosql", "nosql", "sql-c", "sql-c", "sql-b", "sql-d"}
+      << QStringLiteral("sql") << QStringList{"sql-c", "sql-d", "sql-b", "sql-a", "nosql"};
+  QTest::newRow("typos by shared trigrams")
+      << QStringList{"passwd", "pasword", "word", "password-reset"} << QStringList()
+      << QStringLiteral("password") << QStringList{"password-reset", "pasword", "passwd"};
+  QTest::newRow("no match") << QStringList{"xss", "csrf"} << QStringList()
+                            << QStringLiteral("ssrf-chain") << QStringList();
+}
+
+void tst_TagCompletion::ranking() {
+  QFETCH(QStringList, tags);
+  QFETCH(QStringList, used);
+  QFETCH(QString, query);
+  QFETCH(QStringList, expected);
+
+  TagCompletionModel model;
+  model.setTags(tags);
+  for (const auto &name : std::as_const(used))
+    model.noteUsed(name);
+  model.setFilter(query);
+
+  QStringList results;
+  for (int row = 0; row < model.rowCount(); row++)
+    results.append(model.data(model.index(row)).toString());
+  QCOMPARE(results, expected);
+}
+
+void tst_TagCompletion::typeQuery_data() {
+  QTest::addColumn<QString>("query");
+  QTest::addColumn<bool>("matches");
+  QTest::newRow("prefix") << QStringLiteral("database-admin") << true;
+  QTest::newRow("word start") << QStringLiteral("password-1") << true;
+  QTest::newRow("substring") << QStringLiteral("ssion-clo") << true;
+  QTest::newRow("typo") << QStringLiteral("pasword-tokn") << true;
+  QTest::newRow("no match") << QStringLiteral("zzzzzzzz") << false;
+}
+
+void tst_TagCompletion::typeQuery() {
+  QFETCH(QString, query);
+  QFETCH(bool, matches);
+
+  TagCompletionModel model;
+  model.setTags(_tags);
+  QCOMPARE(model.rowCount(), tagCount);
+
+  // the best of three rounds, per keystroke, so that a single hiccup doesn't skew the result
+  QList<qint64> bestNs(query.size(), std::numeric_limits<qint64>::max());
+  for (int round = 0; round < 3; round++) {
+    model.setFilter(QString());
+    for (int i = 0; i < query.size(); i++) {
+      const auto typed = query.left(i + 1);
+      QElapsedTimer timer;
+      timer.start();
+      model.setFilter(typed);
+      bestNs[i] = std::min(bestNs[i], timer.nsecsElapsed());
+      QVERIFY(model.rowCount() <= TagCompletionModel::maxResults);
+    }
+    QCOMPARE(model.rowCount() > 0, matches);
+  }
+  // the target is for release builds; unoptimized builds are only benchmarked
+#ifdef QT_NO_DEBUG
+  for (int i = 0; i < query.size(); i++) {
+    TestTiming::reportTarget(QStringLiteral("Typing \"%1\"").arg(query.left(i + 1)),
+                             bestNs.at(i), maxKeystrokeNs);
+  }
+#endif
+
+  // one iteration types the whole query, then clears it again
+  QBENCHMARK {
+    for (int i = 0; i < query.size(); i++)
+      model.setFilter(query.left(i + 1));
+    model.setFilter(QString());
+  }
+}
+
+QTEST_GUILESS_MAIN(tst_TagCompletion)
+#include "tst_tagcompletion.moc"
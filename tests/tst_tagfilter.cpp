@@ -0,0 +1,129 @@
+#include <algorithm>
+
+#include <QSet>
+#include <QtTest>
+
+#include "testsupport.h"
+
+Q_DECLARE_METATYPE(EvidenceFilters)
+
+/**
+ * @brief tst_TagFilter checks tag: and -tag: filters against a large tag set (50k evidence carrying
+ * 200k tags, drawn from 1000 names): the evidence found must be exactly the evidence expected from
+ * the generated data. Each filter is then benchmarked, against a target of under 100ms.
+ */
+class tst_TagFilter : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void filterByTags_data();
+  void filterByTags();
+
+ private:
+  /// expectedIDs works out, from the generated data, which evidence filters should find
+  static QList<qint64> expectedIDs(const EvidenceFilters &filters);
+
+  inline static const int evidenceCount = 50000;
+  inline static const int tagsPerEvidence = 4;
+  inline static const int distinctTags = 1000;
+  inline static const qint64 maxFilterMs = 100;
+  std::unique_ptr<TestDatabase> _db;
+};
+
+void tst_TagFilter::initTestCase() {
+  _db = std::make_unique<TestDatabase>(QStringLiteral("tst_tagfilter"));
+  QVERIFY2(_db->isOpen(), qPrintable(_db->errorString()));
+
+  const auto evidence = TestData::evidence(evidenceCount);
+  QVERIFY2(_db->get()->batchCopyFullEvidence(evidence), qPrintable(_db->errorString()));
+  QVERIFY2(_db->get()->batchCopyTags(TestData::tags(evidence, tagsPerEvidence, distinctTags)),
+           qPrintable(_db->errorString()));
+}
+
+void tst_TagFilter::cleanupTestCase() {
+  _db.reset();
+}
+
+void tst_TagFilter::filterByTags_data() {
+  QTest::addColumn<EvidenceFilters>("filters");
+  QTest::addColumn<bool>("includeTags");
+
+  QStringList fifty;
+  for (int tag = 0; tag < 50; tag++)
+    fifty.append(TestData::tagName(tag * 17));
+
+  const QList<QPair<QString, QString>> filters = {
+      {QStringLiteral("one tag"), QStringLiteral("tag: tag-42")},
+      {QStringLiteral("one tag, other case"), QStringLiteral("tag: TAG-42")},
+      {QStringLiteral("any of three"), QStringLiteral("tag: tag-1|tag-2|tag-3")},
+      {QStringLiteral("two groups"), QStringLiteral("tag: tag-7|tag-8 tag: tag-138|tag-139")},
+      {QStringLiteral("any of fifty"), QStringLiteral("tag: ") + fifty.join(QLatin1Char('|'))},
+      {QStringLiteral("with excluded"), QStringLiteral("tag: tag-1|tag-2|tag-3 -tag: tag-132")},
+      {QStringLiteral("operation and tags"),
+       QStringLiteral("op: op-2 tag: tag-1|tag-2|tag-3 -tag: tag-132|tag-263")},
+  };
+  for (const auto &[name, text] : filters) {
+    const auto parsed = EvidenceFilters::parseFilter(text);
+    QTest::newRow(qPrintable(name)) << parsed << false;
+    QTest::newRow(qPrintable(name + QStringLiteral(" (with tags)"))) << parsed << true;
+  }
+}
+
+void tst_TagFilter::filterByTags() {
+  QFETCH(EvidenceFilters, filters);
+  QFETCH(bool, includeTags);
+
+  auto run = [&]() {
+    return includeTags ? _db->get()->getFullEvidenceWithFilters(filters)
+                       : _db->get()->getEvidenceWithFilters(filters);
+  };
+
+  const auto found = run();
+  QList<qint64> foundIDs;
+  for (const auto &evi : found) {
+    foundIDs.append(evi.id);
+    if (includeTags)
+      QCOMPARE(evi.tags.size(), qsizetype(tagsPerEvidence));
+  }
+  std::sort(foundIDs.begin(), foundIDs.end());
+  const auto expected = expectedIDs(filters);
+  QVERIFY(!expected.isEmpty());
+  QCOMPARE(foundIDs, expected);
+
+  TestTiming::reportTarget(QString::fromLatin1(QTest::currentDataTag()),
+                           TestTiming::bestOfThreeNs([&run] { run(); }), maxFilterMs * 1000000);
+  QBENCHMARK {
+    auto results = run();
+    Q_UNUSED(results);
+  }
+}
+
+QList<qint64> tst_TagFilter::expectedIDs(const EvidenceFilters &filters) {
+  auto hasAny = [](const QSet<QString> &carried, const QStringList &names) {
+    return std::any_of(names.cbegin(), names.cend(), [&carried](const QString &name) {
+      return carried.contains(name.toLower());
+    });
+  };
+
+  QList<qint64> rtn;
+  for (int i = 0; i < evidenceCount; i++) {
+    if (!filters.operationSlug.isEmpty() && TestData::operationSlug(i) != filters.operationSlug)
+      continue;
+    QSet<QString> carried;
+    for (int k = 0; k < tagsPerEvidence; k++)
+      carried.insert(TestData::tagName(TestData::tagIndex(i, k, distinctTags)));
+
+    // every group must be matched (by any of its tags), and no excluded tag may be carried
+    const bool inGroups =
+        std::all_of(filters.tags.cbegin(), filters.tags.cend(),
+                    [&](const QStringList &group) { return hasAny(carried, group); });
+    if (inGroups && !hasAny(carried, filters.excludedTags))
+      rtn.append(i + 1);
+  }
+  return rtn;
+}
+
+QTEST_GUILESS_MAIN(tst_TagFilter)
+#include "tst_tagfilter.moc"